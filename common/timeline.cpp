@@ -0,0 +1,158 @@
+/**
+ * Timeline — Chrome trace-event output
+ * (see timeline.h)
+ */
+
+#include "timeline.h"
+
+#include <cstdio>
+#include <mutex>
+using namespace std;
+
+atomic<bool> timelineActive{false};
+
+// Buffered output is written once it reaches this size
+const size_t TIMELINE_BUFFER_LIMIT = 1 << 16;
+
+// ---------------------------
+// Output file
+// ---------------------------
+
+namespace {
+
+struct TimelineFile {
+    mutex fileMutex;
+    FILE* out = nullptr;
+    string buffer;
+    bool firstEvent = true;
+    chrono::steady_clock::time_point origin;
+
+    ~TimelineFile() { close(); }
+
+    void append(const string& event) {
+        lock_guard<mutex> lock(fileMutex);
+        if (!out) return;
+        if (!firstEvent) buffer += ",\n";
+        firstEvent = false;
+        buffer += event;
+        if (buffer.size() >= TIMELINE_BUFFER_LIMIT) flushLocked();
+    }
+
+    void flushLocked() {
+        fwrite(buffer.data(), 1, buffer.size(), out);
+        fflush(out);
+        buffer.clear();
+    }
+
+    void close() {
+        lock_guard<mutex> lock(fileMutex);
+        if (!out) return;
+        buffer += "\n]\n";
+        flushLocked();
+        fclose(out);
+        out = nullptr;
+    }
+};
+
+TimelineFile& timelineFile() {
+    static TimelineFile file;
+    return file;
+}
+
+// Small, stable thread ids in order of first use: 1, 2, 3, ...
+atomic<int> nextThreadId{1};
+thread_local int currentThreadId = 0;
+
+int timelineThreadId() {
+    if (currentThreadId == 0) currentThreadId = nextThreadId.fetch_add(1, memory_order_relaxed);
+    return currentThreadId;
+}
+
+void appendJsonString(string& out, string_view s) {
+    static const char hexDigits[] = "0123456789abcdef";
+    out += '"';
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += hexDigits[c >> 4];
+            out += hexDigits[c & 0xF];
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+// Microseconds, to the nanosecond
+string microseconds(chrono::steady_clock::duration d) {
+    char text[32];
+    double us = chrono::duration<double, micro>(d).count();
+    snprintf(text, sizeof(text), "%.3f", us);
+    return text;
+}
+
+} // namespace
+
+bool startTimeline(const string& path) {
+    TimelineFile& file = timelineFile();
+    file.close();
+    FILE* out = fopen(path.c_str(), "w");
+    if (!out) return false;
+    {
+        lock_guard<mutex> lock(file.fileMutex);
+        file.out = out;
+        file.buffer = "[\n";
+        file.firstEvent = true;
+        file.origin = chrono::steady_clock::now();
+    }
+    timelineActive.store(true, memory_order_relaxed);
+    return true;
+}
+
+void stopTimeline() {
+    timelineActive.store(false, memory_order_relaxed);
+    timelineFile().close();
+}
+
+void nameTimelineThread(string_view name) {
+    if (!timelineActive.load(memory_order_relaxed)) return;
+    string event = R"({"name":"thread_name","ph":"M","pid":1,"tid":)" + to_string(timelineThreadId()) + R"(,"args":{"name":)";
+    appendJsonString(event, name);
+    event += "}}";
+    timelineFile().append(event);
+}
+
+// ---------------------------
+// Scopes
+// ---------------------------
+
+TimelineScope::TimelineScope(TraceCategory category, const char* name, string_view argName, string_view argValue)
+    : active(timelineActive.load(memory_order_relaxed)), category(category), name(name) {
+    if (!active) return;
+    this->argName = argName;
+    this->argValue = argValue;
+    start = chrono::steady_clock::now();
+}
+
+TimelineScope::~TimelineScope() {
+    if (!active) return;
+    auto end = chrono::steady_clock::now();
+    string event = R"({"name":)";
+    appendJsonString(event, name);
+    event += R"(,"cat":)";
+    appendJsonString(event, traceCategoryName(category));
+    event += R"(,"ph":"X","ts":)" + microseconds(start - timelineFile().origin) + R"(,"dur":)" + microseconds(end - start) +
+             R"(,"pid":1,"tid":)" + to_string(timelineThreadId());
+    if (!argName.empty()) {
+        event += R"(,"args":{)";
+        appendJsonString(event, argName);
+        event += ':';
+        appendJsonString(event, argValue);
+        event += '}';
+    }
+    event += '}';
+    timelineFile().append(event);
+}
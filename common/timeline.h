@@ -0,0 +1,67 @@
+/**
+ * Timeline
+ * ========
+ *
+ * Scoped spans around pipeline stages and per-file tasks, written as Chrome
+ * trace-event JSON for chrome://tracing or https://ui.perfetto.dev:
+ *
+ *   TIMELINE_SCOPE(TraceCategory::Normalize, "removeComments");
+ *   TIMELINE_SCOPE_ARG(TraceCategory::Input, "file", "path", fileName);
+ *
+ * Each span becomes one complete event ("ph": "X") with its start and duration
+ * in microseconds, the category, a small per-thread id (tid) and optionally one
+ * string argument, so a slow file or a stalled worker shows up by name.
+ *
+ * The timeline is off until startTimeline(); a scope then costs one relaxed
+ * atomic load. Events are formatted on the calling thread and appended to one
+ * buffered, mutex-protected file, like the trace sink (trace.h). The file is
+ * the JSON array format, whose closing "]" is optional, so a run that dies
+ * midway still leaves a loadable timeline.
+ */
+
+#ifndef TIMELINE_H
+#define TIMELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <string_view>
+#include "trace.h"
+
+extern std::atomic<bool> timelineActive;
+
+// Start recording into `path`; returns false if it cannot be created
+bool startTimeline(const std::string& path);
+
+// Write out the remaining events and close the file (also done at exit)
+void stopTimeline();
+
+// Label the calling thread in the viewer ("main", "worker 3", ...)
+void nameTimelineThread(std::string_view name);
+
+class TimelineScope {
+public:
+    TimelineScope(TraceCategory category, const char* name)
+        : TimelineScope(category, name, {}, {}) {}
+    TimelineScope(TraceCategory category, const char* name, std::string_view argName, std::string_view argValue);
+    ~TimelineScope();
+
+    TimelineScope(const TimelineScope&) = delete;
+    TimelineScope& operator=(const TimelineScope&) = delete;
+
+private:
+    bool active;
+    TraceCategory category;
+    const char* name;
+    std::string argName, argValue;
+    std::chrono::steady_clock::time_point start;
+};
+
+#define TIMELINE_CONCAT_INNER(a, b) a##b
+#define TIMELINE_CONCAT(a, b) TIMELINE_CONCAT_INNER(a, b)
+#define TIMELINE_SCOPE(category, name) \
+    TimelineScope TIMELINE_CONCAT(timelineScope, __LINE__)(category, name)
+#define TIMELINE_SCOPE_ARG(category, name, argName, argValue) \
+    TimelineScope TIMELINE_CONCAT(timelineScope, __LINE__)(category, name, argName, argValue)
+
+#endif // TIMELINE_H
@@ -0,0 +1,135 @@
+/**
+ * Tracing — sink and configuration
+ * (see trace.h)
+ */
+
+#include "trace.h"
+
+#include <array>
+using namespace std;
+
+atomic<int> traceLevel{static_cast<int>(TraceLevel::Off)};
+atomic<uint32_t> traceCategories{TRACE_ALL_CATEGORIES};
+
+// Buffered output is written once it reaches this size
+const size_t TRACE_BUFFER_LIMIT = 1 << 16;
+
+constexpr array<string_view, 6> levelNames = {"off", "error", "warn", "info", "debug", "trace"};
+
+struct CategoryName {
+    string_view name;
+    TraceCategory category;
+};
+constexpr CategoryName categoryNames[] = {
+    {"input", TraceCategory::Input},
+    {"normalize", TraceCategory::Normalize},
+    {"tokenize", TraceCategory::Tokenize},
+    {"kgram", TraceCategory::KGram},
+    {"hash", TraceCategory::Hash},
+    {"similarity", TraceCategory::Similarity},
+    {"index", TraceCategory::Index},
+    {"cache", TraceCategory::Cache},
+};
+
+string_view traceCategoryName(TraceCategory category) {
+    for (const CategoryName& entry : categoryNames) {
+        if (entry.category == category) return entry.name;
+    }
+    return "?";
+}
+
+bool configureTrace(string_view spec) {
+    size_t colon = spec.find(':');
+    string_view levelPart = spec.substr(0, colon);
+    int level = -1;
+    for (size_t i = 0; i < levelNames.size(); ++i) {
+        if (levelNames[i] == levelPart) level = static_cast<int>(i);
+    }
+    if (level < 0) return false;
+
+    uint32_t categories = TRACE_ALL_CATEGORIES;
+    if (colon != string_view::npos) {
+        categories = 0;
+        string_view list = spec.substr(colon + 1);
+        while (!list.empty()) {
+            size_t comma = list.find(',');
+            string_view name = list.substr(0, comma);
+            list = comma == string_view::npos ? string_view() : list.substr(comma + 1);
+            if (name == "all") {
+                categories = TRACE_ALL_CATEGORIES;
+                continue;
+            }
+            bool known = false;
+            for (const CategoryName& entry : categoryNames) {
+                if (entry.name == name) {
+                    categories |= static_cast<uint32_t>(entry.category);
+                    known = true;
+                }
+            }
+            if (!known) return false;
+        }
+    }
+
+    traceLevel.store(level, memory_order_relaxed);
+    traceCategories.store(categories, memory_order_relaxed);
+    return true;
+}
+
+bool setTraceFile(const string& path) {
+    return traceSink().open(path);
+}
+
+// ---------------------------
+// Sink
+// ---------------------------
+
+TraceSink& traceSink() {
+    static TraceSink sink;
+    return sink;
+}
+
+TraceSink::~TraceSink() {
+    flush();
+    if (out != stderr) fclose(out);
+}
+
+void TraceSink::write(string_view line) {
+    lock_guard<mutex> lock(bufferMutex);
+    buffer.append(line);
+    buffer.push_back('\n');
+    if (buffer.size() >= TRACE_BUFFER_LIMIT) flushLocked();
+}
+
+void TraceSink::flush() {
+    lock_guard<mutex> lock(bufferMutex);
+    flushLocked();
+}
+
+void TraceSink::flushLocked() {
+    if (buffer.empty()) return;
+    fwrite(buffer.data(), 1, buffer.size(), out);
+    fflush(out);
+    buffer.clear();
+}
+
+bool TraceSink::open(const string& path) {
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) return false;
+    lock_guard<mutex> lock(bufferMutex);
+    flushLocked();
+    if (out != stderr) fclose(out);
+    out = file;
+    return true;
+}
+
+// ---------------------------
+// Records
+// ---------------------------
+
+TraceRecord::TraceRecord(TraceLevel level, TraceCategory category) {
+    text << '[' << levelNames[static_cast<int>(level)] << ' ' << traceCategoryName(category) << "] ";
+}
+
+TraceRecord::~TraceRecord() {
+    traceSink().write(text.view());
+}
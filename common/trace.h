@@ -0,0 +1,116 @@
+/**
+ * Tracing
+ * =======
+ *
+ * Debug output for both detectors, with a level and a pipeline-stage category
+ * per message:
+ *
+ *   TRACE(TraceLevel::Trace, TraceCategory::KGram, "K-gram: " << kgram);
+ *
+ * A message is written only if its level is enabled at run time (--trace) and
+ * its category is selected. Levels above TRACE_MAX_LEVEL are removed at compile
+ * time: the message expression is still type-checked but generates no code, not
+ * even the run-time test. By default every level is compiled in, except in
+ * release builds (NDEBUG), which keep up to Info so the per-token and per-k-gram
+ * messages cost nothing there.
+ *
+ * Messages go through one buffered, mutex-protected sink: each message is
+ * formatted on the calling thread and appended to the buffer as a whole line,
+ * and the buffer is written out in large blocks (and at exit) instead of being
+ * flushed per line.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <string_view>
+
+enum class TraceLevel : int { Off = 0, Error, Warn, Info, Debug, Trace };
+
+// One bit per pipeline stage
+enum class TraceCategory : uint32_t {
+    Input = 1u << 0,      // reading files
+    Normalize = 1u << 1,  // whitespace, case, comments, variable names
+    Tokenize = 1u << 2,
+    KGram = 1u << 3,      // k-gram and shingle construction
+    Hash = 1u << 4,       // fingerprint sets
+    Similarity = 1u << 5, // Jaccard matrix and passage matching
+    Index = 1u << 6,      // persisted and in-memory indexes
+    Cache = 1u << 7,      // fingerprint cache and checkpoints
+};
+constexpr uint32_t TRACE_ALL_CATEGORIES = (1u << 8) - 1;
+
+// "input", "normalize", ... as accepted by configureTrace()
+std::string_view traceCategoryName(TraceCategory category);
+
+// Highest level compiled in: 0 (off) .. 5 (trace)
+#ifndef TRACE_MAX_LEVEL
+#ifdef NDEBUG
+#define TRACE_MAX_LEVEL 3
+#else
+#define TRACE_MAX_LEVEL 5
+#endif
+#endif
+
+// Run-time selection; off until configured
+extern std::atomic<int> traceLevel;
+extern std::atomic<uint32_t> traceCategories;
+
+inline bool traceEnabled(TraceLevel level, TraceCategory category) {
+    return static_cast<int>(level) <= traceLevel.load(std::memory_order_relaxed) &&
+           (traceCategories.load(std::memory_order_relaxed) & static_cast<uint32_t>(category)) != 0;
+}
+
+// Parse "LEVEL[:CATEGORY[,CATEGORY...]]", e.g. "debug" or "trace:kgram,hash",
+// and apply it; returns false (changing nothing) if the spec is not valid
+bool configureTrace(std::string_view spec);
+
+// Send trace output to `path` instead of stderr; returns false if it cannot be opened
+bool setTraceFile(const std::string& path);
+
+class TraceSink {
+public:
+    ~TraceSink();
+
+    void write(std::string_view line);
+    void flush();
+    bool open(const std::string& path);
+
+private:
+    void flushLocked();
+
+    std::mutex bufferMutex;
+    std::string buffer;
+    FILE* out = stderr;
+};
+
+TraceSink& traceSink();
+
+// One message: formatted locally, handed to the sink as a single line when destroyed
+class TraceRecord {
+public:
+    TraceRecord(TraceLevel level, TraceCategory category);
+    ~TraceRecord();
+    std::ostringstream& stream() { return text; }
+
+private:
+    std::ostringstream text;
+};
+
+#define TRACE(level, category, message)                                      \
+    do {                                                                     \
+        if constexpr (static_cast<int>(level) <= TRACE_MAX_LEVEL) {          \
+            if (traceEnabled(level, category)) {                             \
+                TraceRecord traceRecord(level, category);                    \
+                traceRecord.stream() << message;                             \
+            }                                                                \
+        }                                                                    \
+    } while (false)
+
+#endif // TRACE_H
@@ -0,0 +1,94 @@
+/**
+ * Passage-Tagged Fingerprint Index — implementation
+ * (see passage_index.h for the layout)
+ */
+
+#include "passage_index.h"
+
+#include <algorithm>
+#include <unordered_set>
+using namespace std;
+
+void PassageIndex::add(unsigned long fingerprint, const PassagePosting& posting) {
+    pending.push_back({fingerprint, posting});
+}
+
+void PassageIndex::build() {
+    sort(pending.begin(), pending.end(), [](const auto& a, const auto& b) {
+        if (a.first != b.first) return a.first < b.first;
+        if (a.second.document != b.second.document) return a.second.document < b.second.document;
+        return a.second.sentence < b.second.sentence;
+    });
+
+    fingerprints.clear();
+    offsets.clear();
+    postings.clear();
+    postings.reserve(pending.size());
+    for (const auto& [fp, posting] : pending) {
+        if (fingerprints.empty() || fingerprints.back() != fp) {
+            fingerprints.push_back(fp);
+            offsets.push_back(postings.size());
+        }
+        postings.push_back(posting);
+    }
+    offsets.push_back(postings.size());
+    pending.clear();
+    pending.shrink_to_fit();
+}
+
+// Merge sentence-pair matches into runs: a match joins a run when both of its
+// sentences fall inside, or right after, the run's sentences in each document
+static vector<PassageMatch> mergeIntoRuns(vector<PassageMatch>& matches) {
+    sort(matches.begin(), matches.end(), [](const PassageMatch& a, const PassageMatch& b) {
+        return a.firstA != b.firstA ? a.firstA < b.firstA : a.firstB < b.firstB;
+    });
+
+    vector<PassageMatch> runs;
+    for (const PassageMatch& m : matches) {
+        bool merged = false;
+        for (PassageMatch& run : runs) {
+            bool joinsA = m.firstA >= run.firstA && m.firstA <= run.lastA + 1;
+            bool joinsB = m.firstB >= run.firstB && m.firstB <= run.lastB + 1;
+            if (joinsA && joinsB) {
+                run.lastA = max(run.lastA, m.lastA);
+                run.lastB = max(run.lastB, m.lastB);
+                run.sharedKGrams += m.sharedKGrams;
+                merged = true;
+                break;
+            }
+        }
+        if (!merged) runs.push_back(m);
+    }
+    return runs;
+}
+
+map<DocumentPair, vector<PassageMatch>> PassageIndex::matchPairs(const vector<DocumentPair>& pairs,
+                                                                 size_t maxOccurrences) const {
+    unordered_set<uint64_t> wanted;
+    for (const DocumentPair& pair : pairs) {
+        wanted.insert((static_cast<uint64_t>(pair.first) << 32) | pair.second);
+    }
+
+    map<DocumentPair, vector<PassageMatch>> matches;
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+        uint64_t begin = offsets[i], end = offsets[i + 1];
+        if (end - begin < 2 || end - begin > maxOccurrences) continue;
+
+        // Postings are sorted by document, so x < y means a.document <= b.document
+        for (uint64_t x = begin; x < end; ++x) {
+            for (uint64_t y = x + 1; y < end; ++y) {
+                const PassagePosting& a = postings[x];
+                const PassagePosting& b = postings[y];
+                if (a.document == b.document) continue;
+                if (!wanted.count((static_cast<uint64_t>(a.document) << 32) | b.document)) continue;
+                matches[{a.document, b.document}].push_back(
+                    {a.sentence, a.sentence + a.sentenceSpan, b.sentence, b.sentence + b.sentenceSpan, 1});
+            }
+        }
+    }
+
+    for (auto& [pair, list] : matches) {
+        list = mergeIntoRuns(list);
+    }
+    return matches;
+}
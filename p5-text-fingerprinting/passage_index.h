@@ -0,0 +1,66 @@
+/**
+ * Passage-Tagged Fingerprint Index
+ * ================================
+ *
+ * Every k-gram fingerprint is recorded with the place it came from: the
+ * document and the sentence its first token is in, plus how many sentence
+ * boundaries the k-gram crosses. Sentences are numbered per document, and the
+ * document keeps the paragraph of each sentence, so a posting is 12 bytes.
+ *
+ * Postings are added while the fingerprints are computed and then sorted once
+ * into a flat (CSR-style) layout:
+ *   fingerprints[i]                         i-th distinct fingerprint, ascending
+ *   postings[offsets[i] .. offsets[i + 1])  where it occurs, by document then sentence
+ * The matching passages of any set of document pairs then come from a single
+ * walk over the posting lists; the documents are not read or aligned again.
+ */
+
+#ifndef PASSAGE_INDEX_H
+#define PASSAGE_INDEX_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <utility>
+#include <vector>
+
+struct PassagePosting {
+    uint32_t document;
+    uint32_t sentence;     // sentence of the k-gram's first token
+    uint32_t sentenceSpan; // sentence boundaries crossed before its last token
+};
+
+// Sentences [firstA, lastA] of one document share `sharedKGrams` k-grams with
+// sentences [firstB, lastB] of the other
+struct PassageMatch {
+    uint32_t firstA, lastA;
+    uint32_t firstB, lastB;
+    uint32_t sharedKGrams;
+};
+
+using DocumentPair = std::pair<uint32_t, uint32_t>; // first < second
+
+class PassageIndex {
+public:
+    void add(unsigned long fingerprint, const PassagePosting& posting);
+
+    // Sort the added postings into posting lists; call once after the last add()
+    void build();
+
+    // Matching passages of each pair, merged into runs of adjacent sentences and
+    // ordered by position in the first document. Fingerprints occurring more than
+    // maxOccurrences times (boilerplate) are skipped.
+    std::map<DocumentPair, std::vector<PassageMatch>> matchPairs(const std::vector<DocumentPair>& pairs,
+                                                                 size_t maxOccurrences = 64) const;
+
+    size_t fingerprintCount() const { return fingerprints.size(); }
+    size_t postingCount() const { return postings.size(); }
+
+private:
+    std::vector<std::pair<unsigned long, PassagePosting>> pending;
+    std::vector<unsigned long> fingerprints;
+    std::vector<uint64_t> offsets; // fingerprints.size() + 1 entries
+    std::vector<PassagePosting> postings;
+};
+
+#endif // PASSAGE_INDEX_H
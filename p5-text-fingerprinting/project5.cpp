@@ -8,8 +8,8 @@
  *
  * Functionality:
  * 1. Reads multiple text files as input
- * 2. Cleans and normalizes the text (lowercase, whitespace normalization)
- * 3. Tokenizes the text into words using regex
+ * 2. Cleans and normalizes the text (lowercase, whitespace normalization; UTF-8 aware)
+ * 3. Tokenizes the text into words with a table-driven scanner (any common script)
  * 4. Generates k-grams (sequences of k consecutive tokens)
  * 5. Hashes each k-gram using a polynomial rolling hash function
  * 6. Stores hashes in an unordered_set for efficient comparison
@@ -32,10 +32,22 @@
 #include <sstream>
 #include <string>
 #include <vector>
+#include <string_view>
 #include <unordered_set>
-#include <regex>
+#include <array>
+#include <bit>
 #include <algorithm>
+#include <map>
+#include <cstdint>
+#include <limits>
 //#include <iomanip> // for precision
+#include "passage_index.h"
+#include "simhash.h"
+#include "stopword_filter.h"
+#include "stopword_table.h" // generated from test-corpus/stopwords.txt
+#include "text_normalize.h"
+#include "trace.h"
+#include "utf8.h"
 using namespace std;
 
 // ---------------------------
@@ -55,64 +67,127 @@ string readFile(const string& filename) {
     return buffer.str();
 }
 
-// Normalize text: convert to lowercase, remove extra spaces and line breaks
+// Normalize text: convert to lowercase, remove extra spaces and line breaks.
+// Done in a single in-place pass by the vectorized kernel in text_normalize.cpp
+// (same result as tolower followed by the \s+ collapse and ^/$ trim regexes).
 string normalizeText(const string& rawText) {
     string result = rawText;
-
-    // Convert to lowercase
-    transform(result.begin(), result.end(), result.begin(), ::tolower);
-
-    // Replace multiple spaces with a single space using regex
-    regex multipleSpaces("\\s+");
-    result = regex_replace(result, multipleSpaces, " ");
-
-    // Trim leading and trailing spaces
-    regex leadingSpaces("^\\s+");
-    regex trailingSpaces("\\s+$");
-    result = regex_replace(result, leadingSpaces, "");
-    result = regex_replace(result, trailingSpaces, "");
-
+    normalizeWhitespaceAndCase(result);
     return result;
 }
 
-// Read stopwords from file and store in unordered_set
-unordered_set<string> readStopwords(const string& filename) {
-    unordered_set<string> stopwords;
+// Same as normalizeText(), reusing the caller's buffer instead of copying it
+void normalizeTextInPlace(string& text) {
+    normalizeWhitespaceAndCase(text);
+}
+
+// Read stopwords from file into a perfect-hash filter built at run time
+StopwordFilter readStopwords(const string& filename) {
     ifstream file(filename);
     if (!file.is_open()) {
         cerr << "Warning: Stopwords file not found. Proceeding without stopwords removal." << endl;
-        return stopwords;
+        return StopwordFilter();
     }
 
+    vector<string> words;
     string word;
     while (file >> word) {
-        stopwords.insert(word);
+        words.push_back(word);
     }
     file.close();
-    return stopwords;
+    return StopwordFilter(words);
 }
 
-// Tokenize text into words using regex
-vector<string> tokenizeText(const string& text, const unordered_set<string>& stopwords = {}) {
-    vector<string> tokens;
-    regex wordPattern(R"([a-zA-Z0-9]+)");
-    string s = text;
-    smatch match;
+// The stopword list given with --stopwords, or the built-in table generated from
+// test-corpus/stopwords.txt at build time when none is given
+StopwordFilter loadStopwords(const string& filename) {
+    if (filename.empty()) {
+        return StopwordFilter(builtinStopwords);
+    }
+    return readStopwords(filename);
+}
 
-    while (regex_search(s, match, wordPattern)) {
-        string token = match.str(0);
-        // Only add token if it's not a stopword
-        if (stopwords.empty() || stopwords.find(token) == stopwords.end()) {
+// Character classes for the tokenizer: an ASCII word is a maximal run of [a-zA-Z0-9]
+constexpr array<bool, 256> makeWordCharTable() {
+    array<bool, 256> table{};
+    for (int c = 0; c < 256; ++c) {
+        table[c] = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+    }
+    return table;
+}
+constexpr array<bool, 256> isWordChar = makeWordCharTable();
+
+// UTF-8 word segmentation: a word is a maximal run of letters, digits and combining
+// marks of the scripts classified in utf8.cpp; each Han or kana character is a token
+// of its own. Bytes that are not valid UTF-8 separate words.
+void tokenizeUtf8(string_view text, const StopwordFilter& stopwords, vector<string_view>& tokens) {
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    auto emit = [&](size_t start, size_t end) {
+        string_view token = text.substr(start, end - start);
+        if (!stopwords.contains(token)) {
             tokens.push_back(token);
         }
-        s = match.suffix();
+    };
+
+    size_t wordStart = 0;
+    bool inWord = false;
+    size_t i = 0;
+    while (i < n) {
+        CharClass cls;
+        int length = 1;
+        if (data[i] < 0x80) {
+            cls = isWordChar[data[i]] ? CharClass::Word : CharClass::Separator;
+        } else {
+            char32_t cp;
+            length = decodeUtf8(data + i, n - i, cp);
+            cls = length ? classifyCodePoint(cp) : CharClass::Separator;
+            length = max(length, 1);
+        }
+
+        if (cls == CharClass::Word) {
+            if (!inWord) wordStart = i;
+            inWord = true;
+        } else {
+            if (inWord) emit(wordStart, i);
+            inWord = false;
+            if (cls == CharClass::Ideograph) emit(i, i + length);
+        }
+        i += length;
     }
+    if (inWord) emit(wordStart, n);
+}
 
-    return tokens;
+// Tokenize text into words with a single table-driven scan. Tokens are views into
+// `text` (which must outlive them), written into the caller's reusable buffer;
+// stopwords are dropped as they are found. Text with non-ASCII bytes goes through
+// the UTF-8 segmenter above; pure ASCII keeps the byte-table loop.
+void tokenizeText(string_view text, const StopwordFilter& stopwords, vector<string_view>& tokens) {
+    tokens.clear();
+    if (containsNonAscii(text)) {
+        tokenizeUtf8(text, stopwords, tokens);
+        return;
+    }
+    const unsigned char* data = reinterpret_cast<const unsigned char*>(text.data());
+    size_t n = text.size();
+    size_t i = 0;
+
+    while (i < n) {
+        while (i < n && !isWordChar[data[i]]) ++i;
+        size_t start = i;
+        while (i < n && isWordChar[data[i]]) ++i;
+        if (i == start) break;
+
+        string_view token = text.substr(start, i - start);
+        // Only add token if it's not a stopword
+        if (!stopwords.contains(token)) {
+            tokens.push_back(token);
+        }
+    }
 }
 
 // Create k-grams from tokens
-vector<string> createKGrams(const vector<string>& tokens, int k) {
+vector<string> createKGrams(const vector<string_view>& tokens, int k) {
     vector<string> kgrams;
 
     if (tokens.size() < k) {
@@ -144,20 +219,86 @@ unsigned long simpleHash(const string& s) {
     return hash;
 }
 
-// Hash all k-grams and store in unordered_set
-unordered_set<unsigned long> hashKGrams(const vector<string>& kgrams) {
+// simpleHash() of the k-gram starting at tokens[i], without building the joined string
+unsigned long hashKGramAt(const vector<string_view>& tokens, size_t i, int k) {
+    const int base = 257;
+    const int mod = 1000000007;
+    unsigned long hash = 0;
+    for (int j = 0; j < k; ++j) {
+        if (j > 0) hash = (hash * base + ' ') % mod;
+        for (char c : tokens[i + j]) {
+            hash = (hash * base + c) % mod;
+        }
+    }
+    return hash;
+}
+
+// Hash all k-grams and store in unordered_set; inOrder, if given, also receives each
+// k-gram's hash in k-gram order (for tagging fingerprints with their passage)
+unordered_set<unsigned long> hashKGrams(const vector<string>& kgrams, vector<unsigned long>* inOrder = nullptr) {
     unordered_set<unsigned long> hashSet;
 
     for (const string& kgram : kgrams) {
-        // Print each k-gram before hashing as specified in the requirements
-        cout << "K-gram: " << kgram << endl;
+        // Each k-gram before hashing, as the requirements ask for (--trace trace:kgram)
+        TRACE(TraceLevel::Trace, TraceCategory::KGram, "K-gram: " << kgram);
         unsigned long hash = simpleHash(kgram);
         hashSet.insert(hash);
+        if (inOrder) inOrder->push_back(hash);
     }
 
     return hashSet;
 }
 
+// Random 64-bit value per byte for the shingle hash (splitmix64, fixed seed)
+constexpr array<uint64_t, 256> makeShingleByteTable() {
+    array<uint64_t, 256> table{};
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (uint64_t& value : table) {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        value = z ^ (z >> 31);
+    }
+    return table;
+}
+constexpr array<uint64_t, 256> shingleByteValue = makeShingleByteTable();
+
+// Hash every n-byte window of the token stream with its separators dropped, so copies
+// that only change punctuation or spacing, or merge and split words, keep their
+// shingles. Cyclic polynomial (buzhash) rolling hash: each step rotates the hash and
+// xors in the entering byte's value and the leaving byte's value rotated by n, so the
+// loop-carried work is one rotate and one xor per byte. Hashes are written to the
+// caller's reusable buffer in stream order.
+void rollingShingleHashes(const vector<string_view>& tokens, int n, string& stream, vector<unsigned long>& hashes) {
+    stream.clear();
+    for (string_view token : tokens) stream.append(token);
+    hashes.clear();
+    if (stream.size() < static_cast<size_t>(n)) {
+        return; // Not enough characters to form a shingle
+    }
+    hashes.resize(stream.size() - n + 1);
+
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(stream.data());
+    uint64_t hash = 0;
+    for (int i = 0; i < n; ++i) {
+        hash = rotl(hash, 1) ^ shingleByteValue[bytes[i]];
+    }
+    hashes[0] = hash;
+    const int leavingRotation = n % 64;
+    for (size_t i = n; i < stream.size(); ++i) {
+        hash = rotl(hash, 1) ^ rotl(shingleByteValue[bytes[i - n]], leavingRotation) ^ shingleByteValue[bytes[i]];
+        hashes[i - n + 1] = hash;
+    }
+}
+
+// Character-shingle fingerprint set, comparable with computeJaccard like a k-gram set
+unordered_set<unsigned long> hashCharShingles(const vector<string_view>& tokens, int n) {
+    string stream;
+    vector<unsigned long> hashes;
+    rollingShingleHashes(tokens, n, stream, hashes);
+    return unordered_set<unsigned long>(hashes.begin(), hashes.end());
+}
+
 // Compute Jaccard similarity between two sets
 double computeJaccard(const unordered_set<unsigned long>& A, const unordered_set<unsigned long>& B) {
     if (A.empty() && B.empty()) {
@@ -178,8 +319,17 @@ double computeJaccard(const unordered_set<unsigned long>& A, const unordered_set
     return static_cast<double>(intersectionSize) / unionSize;
 }
 
+// A pair of documents at or above a similarity threshold, with its similarity
+struct FlaggedPair {
+    DocumentPair documents;
+    double similarity;
+};
+
 //Print similarity matrix with precision.
-void printSimilarityMatrix(const vector<unordered_set<unsigned long>>& allHashes, const vector<string>& fileNames) {
+// Returns the pairs (i < j) at or above flagThreshold, so callers need not recompute them.
+vector<FlaggedPair> printSimilarityMatrix(const vector<unordered_set<unsigned long>>& allHashes, const vector<string>& fileNames,
+                                          double flagThreshold = numeric_limits<double>::infinity()) {
+    vector<FlaggedPair> flagged;
     cout << "\nSimilarity Matrix:" << endl;
     cout << "   ";
     for (const auto& name : fileNames) {
@@ -193,53 +343,534 @@ void printSimilarityMatrix(const vector<unordered_set<unsigned long>>& allHashes
             double similarity = computeJaccard(allHashes[i], allHashes[j]);
             // cout << fixed << setprecision(6) << similarity << " ";
             cout << similarity << " ";
+            if (i < j && similarity >= flagThreshold) {
+                flagged.push_back({{static_cast<uint32_t>(i), static_cast<uint32_t>(j)}, similarity});
+            }
         }
         cout << endl;
     }
+    return flagged;
 }
 
-// This a helper method to help us get the stopword output...
-void processStopwordsOutput(const vector<string>& fileNames, int k, bool removeStopwords, const string& stopwordsFile)
-{
-    // 1. Load stopwords if requested
-    unordered_set<string> stopwords;
-    if (removeStopwords) {
-        stopwords = readStopwords(stopwordsFile);
+// A document read, normalized and tokenized once, shared by every configuration of a sweep
+struct TokenizedDocument {
+    string text;                // normalized text; the tokens point into it
+    vector<string_view> tokens; // every token, stopwords included
+    vector<bool> isStopword;    // stopword mask over tokens
+
+    // Passage structure: sentences are numbered through the document
+    vector<uint32_t> tokenSentence;          // sentence of each token
+    vector<uint32_t> sentenceFirstToken;
+    vector<uint32_t> sentenceParagraph;
+    vector<uint32_t> paragraphFirstSentence;
+    vector<uint32_t> paragraphLine;          // 1-based line in the file where each paragraph starts
+};
+
+// Does the text between two tokens end a sentence? A '.', '!' or '?' followed by a
+// space (so "3.5" and "e.g" inside a word do not), or a CJK full stop, '!' or '?'.
+bool endsSentence(string_view gap) {
+    size_t terminator = gap.find_first_of(".!?");
+    if (terminator != string_view::npos && gap.find(' ', terminator) != string_view::npos) return true;
+    return gap.find("\xE3\x80\x82") != string_view::npos  // U+3002 ideographic full stop
+        || gap.find("\xEF\xBC\x81") != string_view::npos  // U+FF01 fullwidth '!'
+        || gap.find("\xEF\xBC\x9F") != string_view::npos; // U+FF1F fullwidth '?'
+
+}
+
+// Paragraphs are separated by blank lines. Each one is normalized on its own and joined
+// with a single space, which gives exactly the text normalizing the whole file would.
+// Returns the offset of each paragraph in doc.text.
+vector<size_t> normalizeParagraphs(const string& raw, TokenizedDocument& doc) {
+    vector<size_t> paragraphOffset;
+    string paragraph;
+    size_t start = 0, lineStart = 0;
+    uint32_t line = 1, startLine = 1;
+
+    auto flush = [&](size_t end) {
+        paragraph.assign(raw, start, end - start);
+        normalizeTextInPlace(paragraph);
+        if (paragraph.empty()) return;
+        if (!doc.text.empty()) doc.text += ' ';
+        paragraphOffset.push_back(doc.text.size());
+        doc.paragraphLine.push_back(startLine);
+        doc.text += paragraph;
+    };
+
+    while (lineStart < raw.size()) {
+        size_t lineEnd = raw.find('\n', lineStart);
+        if (lineEnd == string::npos) lineEnd = raw.size();
+        bool blank = raw.find_first_not_of(" \t\r\v\f", lineStart) >= lineEnd;
+        if (blank) {
+            flush(lineStart);
+            start = lineEnd;
+            startLine = line + 1;
+        }
+        lineStart = lineEnd + 1;
+        ++line;
     }
+    flush(raw.size());
+    return paragraphOffset;
+}
 
+// Number the sentences and record which paragraph each one is in
+void tagSentences(TokenizedDocument& doc, const vector<size_t>& paragraphOffset) {
+    uint32_t paragraph = 0;
+    size_t previousEnd = 0;
+    for (size_t i = 0; i < doc.tokens.size(); ++i) {
+        size_t offset = doc.tokens[i].data() - doc.text.data();
+        bool newParagraph = false;
+        while (paragraph + 1 < paragraphOffset.size() && offset >= paragraphOffset[paragraph + 1]) {
+            ++paragraph;
+            newParagraph = true;
+        }
+        string_view gap(doc.text.data() + previousEnd, offset - previousEnd);
+        if (i == 0 || newParagraph || endsSentence(gap)) {
+            if (doc.paragraphFirstSentence.size() <= paragraph) {
+                doc.paragraphFirstSentence.resize(paragraph + 1, static_cast<uint32_t>(doc.sentenceFirstToken.size()));
+            }
+            doc.sentenceFirstToken.push_back(static_cast<uint32_t>(i));
+            doc.sentenceParagraph.push_back(paragraph);
+        }
+        doc.tokenSentence.push_back(static_cast<uint32_t>(doc.sentenceFirstToken.size() - 1));
+        previousEnd = offset + doc.tokens[i].size();
+    }
+}
+
+TokenizedDocument tokenizeDocument(const string& filename, const StopwordFilter& stopwords) {
+    TokenizedDocument doc;
+    vector<size_t> paragraphOffset = normalizeParagraphs(readFile(filename), doc);
+    tokenizeText(doc.text, StopwordFilter(), doc.tokens);
+    tagSentences(doc, paragraphOffset);
 
-    // 2. Print the appropriate header
-    cout << "=== Similarity Matrix "
+    doc.isStopword.reserve(doc.tokens.size());
+    for (string_view token : doc.tokens) {
+        doc.isStopword.push_back(stopwords.contains(token));
+    }
+    TRACE(TraceLevel::Info, TraceCategory::Tokenize, filename << ": " << doc.tokens.size() << " tokens in "
+          << doc.sentenceFirstToken.size() << " sentences");
+    return doc;
+}
+
+// The token stream of one configuration, derived from the shared stream through the mask;
+// sentences, if given, receives the sentence of each selected token
+void selectTokens(const TokenizedDocument& doc, bool removeStopwords, vector<string_view>& tokens,
+                  vector<uint32_t>* sentences = nullptr) {
+    if (!removeStopwords) {
+        tokens = doc.tokens;
+        if (sentences) *sentences = doc.tokenSentence;
+        return;
+    }
+    tokens.clear();
+    if (sentences) sentences->clear();
+    for (size_t i = 0; i < doc.tokens.size(); ++i) {
+        if (doc.isStopword[i]) continue;
+        tokens.push_back(doc.tokens[i]);
+        if (sentences) sentences->push_back(doc.tokenSentence[i]);
+    }
+}
+
+// What a document's fingerprint is built from
+enum class ShingleMode {
+    Words,     // k consecutive tokens
+    Characters // k consecutive bytes of the token stream (see hashCharShingles)
+};
+
+struct Options {
+    vector<string> fileNames;
+    vector<int> kValues = {3}; // -k 3,5,7 sweeps several sizes in one run
+    string stopwordsFile;      // empty: the built-in list
+    ShingleMode mode = ShingleMode::Words;
+    size_t streamBlockSize = 0; // --stream: read documents in blocks of this size; 0 reads them whole
+    double passageThreshold = -1; // --passages T: list matching passages of pairs with similarity >= T
+    int simhashDistance = -1;     // --simhash D: list near duplicates within D bits instead of the matrix
+};
+
+void printConfigurationHeader(bool removeStopwords, const char* title = "Similarity Matrix") {
+    cout << "=== " << title << " "
              << (removeStopwords ? "with" : "without")
              << " Stopwords Removed ===\n";
+}
 
-    // 3. For each file: tokenize (with or without stopwords), build k-grams, hash, collecting all sets
-    vector<unordered_set<unsigned long>> allHashedKGrams;
+// "paragraph 2, sentences 3-4 (line 17)" for sentences [first, last] of a document
+string describePassage(const TokenizedDocument& doc, uint32_t first, uint32_t last) {
+    uint32_t paragraph = doc.sentenceParagraph[first];
+    uint32_t inParagraph = first - doc.paragraphFirstSentence[paragraph] + 1;
+    string text = "paragraph " + to_string(paragraph + 1) + ", sentence";
+    if (last > first) {
+        text += "s " + to_string(inParagraph) + "-" + to_string(inParagraph + (last - first));
+    } else {
+        text += " " + to_string(inParagraph);
+    }
+    return text + " (line " + to_string(doc.paragraphLine[paragraph]) + ")";
+}
 
-    for (const string& filename : fileNames) {
-        string rawText = readFile(filename);
-        string cleanText = normalizeText(rawText);
-        vector<string> tokens = tokenizeText(cleanText, stopwords);
+// The start of sentences [first, last], cut at a character boundary
+string passageExcerpt(const TokenizedDocument& doc, uint32_t first, uint32_t last) {
+    const size_t maxLength = 72;
+    size_t begin = doc.tokens[doc.sentenceFirstToken[first]].data() - doc.text.data();
+    uint32_t lastToken = last + 1 < doc.sentenceFirstToken.size() ? doc.sentenceFirstToken[last + 1] - 1
+                                                                 : static_cast<uint32_t>(doc.tokens.size() - 1);
+    size_t end = doc.tokens[lastToken].data() + doc.tokens[lastToken].size() - doc.text.data();
+    if (end - begin <= maxLength) {
+        return doc.text.substr(begin, end - begin);
+    }
+    end = begin + maxLength;
+    while (end > begin && (static_cast<unsigned char>(doc.text[end]) & 0xC0) == 0x80) --end;
+    return doc.text.substr(begin, end - begin) + "...";
+}
+
+// Matching passages of the pairs the similarity matrix flagged, read from the index
+void printMatchingPassages(const vector<TokenizedDocument>& documents, const vector<string>& fileNames,
+                           const vector<FlaggedPair>& flagged, const PassageIndex& index, double threshold) {
+    vector<DocumentPair> pairs;
+    for (const FlaggedPair& f : flagged) pairs.push_back(f.documents);
+
+    cout << "\nMatching Passages (similarity >= " << threshold << "):" << endl;
+    map<DocumentPair, vector<PassageMatch>> matches = index.matchPairs(pairs);
+    for (const FlaggedPair& f : flagged) {
+        auto [a, b] = f.documents;
+        cout << fileNames[a] << " <-> " << fileNames[b] << " (" << f.similarity << ")" << endl;
+        for (const PassageMatch& m : matches[f.documents]) {
+            cout << "  " << describePassage(documents[a], m.firstA, m.lastA) << " <-> "
+                 << describePassage(documents[b], m.firstB, m.lastB) << ": "
+                 << m.sharedKGrams << " shared k-grams" << endl;
+            cout << "    \"" << passageExcerpt(documents[a], m.firstA, m.lastA) << "\"" << endl;
+            cout << "    \"" << passageExcerpt(documents[b], m.firstB, m.lastB) << "\"" << endl;
+        }
+    }
+}
+
+// ---------------------------
+// SimHash near-duplicate mode
+// ---------------------------
+
+// 64-bit SimHash of one token stream, voted by its k-gram (or character-shingle) hashes
+uint64_t documentSimHash(const vector<string_view>& tokens, ShingleMode mode, int k, vector<uint64_t>& features) {
+    features.clear();
+    if (mode == ShingleMode::Characters) {
+        string stream;
+        vector<unsigned long> hashes;
+        rollingShingleHashes(tokens, k, stream, hashes);
+        features.assign(hashes.begin(), hashes.end());
+    } else if (tokens.size() >= static_cast<size_t>(k)) {
+        for (size_t i = 0; i + k <= tokens.size(); ++i) {
+            features.push_back(hashKGramAt(tokens, i, k));
+        }
+    }
+    return computeSimHash(features);
+}
+
+// Near-duplicate pairs found through the permuted-table index, without comparing all pairs
+void printNearDuplicates(const vector<uint64_t>& fingerprints, const vector<string>& fileNames, int maxDistance) {
+    SimHashIndex index(maxDistance);
+    for (uint32_t d = 0; d < fingerprints.size(); ++d) {
+        index.add(d, fingerprints[d]);
+    }
+    index.build();
+
+    cout << "\nNear Duplicates (Hamming distance <= " << maxDistance << " of 64 bits):" << endl;
+    vector<SimHashPair> pairs = index.nearPairs();
+    for (const SimHashPair& pair : pairs) {
+        cout << fileNames[pair.first] << " <-> " << fileNames[pair.second] << ": distance " << pair.distance
+             << " (similarity " << simHashSimilarity(fingerprints[pair.first], fingerprints[pair.second]) << ")" << endl;
+    }
+    if (pairs.empty()) cout << "(none)" << endl;
+}
+
+void processSimHashOutput(const vector<TokenizedDocument>& documents, const Options& options, int k, bool removeStopwords) {
+    printConfigurationHeader(removeStopwords, "SimHash Near Duplicates");
+
+    vector<uint64_t> fingerprints;
+    vector<string_view> tokens;
+    vector<uint64_t> features;
+    for (uint32_t d = 0; d < documents.size(); ++d) {
+        selectTokens(documents[d], removeStopwords, tokens);
+        fingerprints.push_back(documentSimHash(tokens, options.mode, k, features));
+        TRACE(TraceLevel::Debug, TraceCategory::Hash, options.fileNames[d] << ": simhash " << hex
+              << fingerprints.back() << dec << " from " << features.size() << " k-grams");
+    }
+
+    printNearDuplicates(fingerprints, options.fileNames, options.simhashDistance);
+    cout << endl;
+}
+
+// This a helper method to help us get the stopword output...
+void processStopwordsOutput(const vector<TokenizedDocument>& documents, const Options& options, int k, bool removeStopwords)
+{
+    if (options.simhashDistance >= 0) {
+        processSimHashOutput(documents, options, k, removeStopwords);
+        return;
+    }
+
+    // 1. Print the appropriate header
+    printConfigurationHeader(removeStopwords);
+
+    // 2. For each file: take its tokens (with or without stopwords), build k-grams, hash, collecting all sets
+    vector<unordered_set<unsigned long>> allHashedKGrams;
+    vector<string_view> tokens; // reused for every file
+
+    // Passage localization: each k-gram's fingerprint is indexed with its sentences
+    // as it is hashed, so no second pass over the documents is needed
+    bool localize = options.passageThreshold >= 0 && options.mode == ShingleMode::Words;
+    PassageIndex passages;
+    vector<uint32_t> sentences;
+    vector<unsigned long> inOrder;
+
+    for (uint32_t d = 0; d < documents.size(); ++d) {
+        const TokenizedDocument& doc = documents[d];
+        selectTokens(doc, removeStopwords, tokens, localize ? &sentences : nullptr);
+        if (options.mode == ShingleMode::Characters) {
+            allHashedKGrams.push_back(hashCharShingles(tokens, k));
+            continue;
+        }
         vector<string> kgrams = createKGrams(tokens, k);
 
-        unordered_set<unsigned long> hashed = hashKGrams(kgrams);
+        inOrder.clear();
+        unordered_set<unsigned long> hashed = hashKGrams(kgrams, localize ? &inOrder : nullptr);
+        for (size_t i = 0; i < inOrder.size(); ++i) {
+            passages.add(inOrder[i], {d, sentences[i], sentences[i + k - 1] - sentences[i]});
+        }
+        TRACE(TraceLevel::Debug, TraceCategory::Hash, options.fileNames[d] << ": " << kgrams.size() << " k-grams, "
+              << hashed.size() << " distinct");
         allHashedKGrams.push_back(hashed);
     }
 
     // Compute and display similarity matrix
-    printSimilarityMatrix(allHashedKGrams, fileNames);
+    vector<FlaggedPair> flagged = printSimilarityMatrix(allHashedKGrams, options.fileNames,
+                                                        localize ? options.passageThreshold : numeric_limits<double>::infinity());
+    if (localize) {
+        passages.build();
+        printMatchingPassages(documents, options.fileNames, flagged, passages, options.passageThreshold);
+    }
     cout << endl;
 }
 
+// Parameter sweep: every (k, stopwords off/on) configuration from a single read,
+// normalization and tokenization of each file
+void runParameterSweep(const Options& options) {
+    StopwordFilter stopwords = loadStopwords(options.stopwordsFile);
+
+    vector<TokenizedDocument> documents;
+    documents.reserve(options.fileNames.size());
+    for (const string& filename : options.fileNames) {
+        documents.push_back(tokenizeDocument(filename, stopwords));
+    }
+
+    for (int k : options.kValues) {
+        if (options.mode == ShingleMode::Characters) {
+            cout << "##### " << k << "-character shingles #####\n";
+        } else if (options.kValues.size() > 1) {
+            cout << "##### k = " << k << " #####\n";
+        }
+        processStopwordsOutput(documents, options, k, false);
+        processStopwordsOutput(documents, options, k, true);
+    }
+}
+
+// ---------------------------
+// Streaming: bounded memory for very large documents
+// ---------------------------
+
+const size_t DEFAULT_STREAM_BLOCK_SIZE = 1 << 20;
+
+// Fingerprint state of one (k, stopwords) configuration while a document streams past
+struct StreamConfiguration {
+    int k;
+    bool removeStopwords;
+    vector<string> carriedTokens; // word mode: the last k-1 tokens seen
+    string carriedBytes;          // character mode: the last k-1 bytes of the token stream
+    unordered_set<unsigned long> hashes;
+};
+
+// Where a raw block may be cut so that no token and no UTF-8 sequence spans the cut: just
+// after the last ASCII separator. Without one, the whole buffer is carried into the next
+// read, up to STREAM_MAX_CARRY bytes (unspaced CJK text, or a freakishly long token);
+// past that it is cut before its last character so memory stays bounded.
+const size_t STREAM_MAX_CARRY = 1 << 16;
+
+size_t streamCutPoint(string_view buffer) {
+    for (size_t i = buffer.size(); i > 0; --i) {
+        unsigned char c = buffer[i - 1];
+        if (c < 0x80 && !isWordChar[c]) return i;
+    }
+    if (buffer.size() <= STREAM_MAX_CARRY) return 0;
+    size_t i = buffer.size();
+    while ((static_cast<unsigned char>(buffer[i - 1]) & 0xC0) == 0x80 && buffer.size() - i < 3) --i;
+    return i - 1;
+}
+
+// Extend a configuration's fingerprints with the next tokens of its stream. Only
+// k-grams ending in `tokens` are new; the ones before were hashed with the previous block.
+void feedStreamTokens(StreamConfiguration& config, const vector<string_view>& tokens, ShingleMode mode,
+                      vector<string_view>& joined, string& scratch, vector<unsigned long>& hashes) {
+    size_t keep = static_cast<size_t>(config.k - 1);
+    joined.clear();
+
+    if (mode == ShingleMode::Characters) {
+        joined.push_back(config.carriedBytes);
+        joined.insert(joined.end(), tokens.begin(), tokens.end());
+        rollingShingleHashes(joined, config.k, scratch, hashes); // scratch holds the joined bytes
+        config.hashes.insert(hashes.begin(), hashes.end());
+        config.carriedBytes = scratch.substr(scratch.size() - min(keep, scratch.size()));
+        return;
+    }
+
+    for (const string& token : config.carriedTokens) joined.push_back(token);
+    joined.insert(joined.end(), tokens.begin(), tokens.end());
+    for (size_t i = 0; i + config.k <= joined.size(); ++i) {
+        config.hashes.insert(hashKGramAt(joined, i, config.k));
+    }
+    vector<string> carried(joined.end() - min(keep, joined.size()), joined.end());
+    config.carriedTokens = move(carried);
+}
+
+// Fingerprint one document for every configuration in a single pass over fixed-size
+// blocks. Memory stays at about two blocks plus the fingerprint sets, whatever the size
+// of the file; k-grams are not printed.
+void streamDocument(const string& filename, const StopwordFilter& stopwords, ShingleMode mode, size_t blockSize,
+                    vector<StreamConfiguration>& configs) {
+    ifstream file(filename, ios::binary);
+    if (!file.is_open()) {
+        cerr << "Error opening file: " << filename << endl;
+        return;
+    }
+
+    string buffer; // raw bytes carried from the previous block, then the new block
+    string text;   // the normalized part of the buffer before the cut
+    vector<string_view> allTokens, selected, joined;
+    vector<bool> isStopword;
+    string scratch;
+    vector<unsigned long> hashes;
+
+    bool atEnd = false;
+    while (!atEnd) {
+        size_t carried = buffer.size();
+        buffer.resize(carried + blockSize);
+        file.read(buffer.data() + carried, blockSize);
+        buffer.resize(carried + file.gcount());
+        atEnd = !file;
+
+        size_t cut = atEnd ? buffer.size() : streamCutPoint(buffer);
+        text.assign(buffer, 0, cut);
+        buffer.erase(0, cut);
+        TRACE(TraceLevel::Debug, TraceCategory::Input, filename << ": block of " << text.size() << " bytes, "
+              << buffer.size() << " carried");
+        normalizeTextInPlace(text);
+        tokenizeText(text, StopwordFilter(), allTokens);
+
+        isStopword.clear();
+        for (string_view token : allTokens) isStopword.push_back(stopwords.contains(token));
+
+        for (StreamConfiguration& config : configs) {
+            selected.clear();
+            for (size_t i = 0; i < allTokens.size(); ++i) {
+                if (!config.removeStopwords || !isStopword[i]) selected.push_back(allTokens[i]);
+            }
+            feedStreamTokens(config, selected, mode, joined, scratch, hashes);
+        }
+    }
+}
+
+// The parameter sweep, with every document streamed once for all configurations
+void runStreamingSweep(const Options& options) {
+    StopwordFilter stopwords = loadStopwords(options.stopwordsFile);
+
+    // perFile[f][c]: fingerprints of file f under configuration c
+    vector<vector<StreamConfiguration>> perFile;
+    for (const string& filename : options.fileNames) {
+        vector<StreamConfiguration> configs;
+        for (int k : options.kValues) {
+            configs.push_back({k, false, {}, {}, {}});
+            configs.push_back({k, true, {}, {}, {}});
+        }
+        streamDocument(filename, stopwords, options.mode, options.streamBlockSize, configs);
+        perFile.push_back(move(configs));
+    }
+
+    for (size_t c = 0; c < 2 * options.kValues.size(); ++c) {
+        int k = options.kValues[c / 2];
+        bool removeStopwords = c % 2 == 1;
+        if (!removeStopwords) {
+            if (options.mode == ShingleMode::Characters) {
+                cout << "##### " << k << "-character shingles #####\n";
+            } else if (options.kValues.size() > 1) {
+                cout << "##### k = " << k << " #####\n";
+            }
+        }
+        printConfigurationHeader(removeStopwords);
+
+        vector<unordered_set<unsigned long>> allHashedKGrams;
+        for (vector<StreamConfiguration>& configs : perFile) {
+            allHashedKGrams.push_back(move(configs[c].hashes));
+        }
+        printSimilarityMatrix(allHashedKGrams, options.fileNames);
+        cout << endl;
+    }
+}
+
 // ---------------------------
 // Step 2: Main Program Logic
 // ---------------------------
 
+// Parse "-k 3,5,7", "--chars", "--stopwords FILE", "--passages T", "--simhash D",
+// "--stream [--block-size BYTES]", "--trace SPEC", "--trace-file FILE" and file names;
+// returns false on bad usage
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (arg == "-k" && i + 1 < argc) {
+            options.kValues.clear();
+            stringstream list(argv[++i]);
+            string value;
+            while (getline(list, value, ',')) {
+                int k = atoi(value.c_str());
+                if (k <= 0) return false;
+                options.kValues.push_back(k);
+            }
+        } else if (arg == "--chars") {
+            options.mode = ShingleMode::Characters;
+        } else if (arg == "--stopwords" && i + 1 < argc) {
+            options.stopwordsFile = argv[++i];
+        } else if (arg == "--passages" && i + 1 < argc) {
+            options.passageThreshold = atof(argv[++i]);
+        } else if (arg == "--simhash" && i + 1 < argc) {
+            options.simhashDistance = atoi(argv[++i]);
+            if (options.simhashDistance < 0 || options.simhashDistance > SIMHASH_MAX_DISTANCE) return false;
+        } else if (arg == "--stream") {
+            if (options.streamBlockSize == 0) options.streamBlockSize = DEFAULT_STREAM_BLOCK_SIZE;
+        } else if (arg == "--block-size" && i + 1 < argc) {
+            long long size = atoll(argv[++i]);
+            if (size <= 0) return false;
+            options.streamBlockSize = static_cast<size_t>(size);
+        } else if (arg == "--trace" && i + 1 < argc) {
+            if (!configureTrace(argv[++i])) return false;
+        } else if (arg == "--trace-file" && i + 1 < argc) {
+            if (!setTraceFile(argv[++i])) {
+                cerr << "Error: cannot write trace file " << argv[i] << endl;
+                return false;
+            }
+        } else if (arg[0] == '-') {
+            return false;
+        } else {
+            options.fileNames.push_back(arg);
+        }
+    }
+    return !options.kValues.empty();
+}
+
 int main(int argc, char* argv[]) {
     // Parse input arguments or hardcode test filenames
-    vector<string> fileNames = {"test-corpus/t1.txt", "test-corpus/t2.txt", "test-corpus/t3.txt", "test-corpus/t4.txt", "test-corpus/t5.txt", "test-corpus/t6.txt", "test-corpus/t7.txt", "test-corpus/t8.txt"};
-    //vector<string> fileNames = {"test-corpus/tA.txt", "test-corpus/tB.txt"}; // just for debugging and testing
-    int k =3; // Changed this value to 3, 5, or 7 for different k-gram analyses
+    Options options;
+    //options.fileNames = {"test-corpus/tA.txt", "test-corpus/tB.txt"}; // just for debugging and testing
+    if (!parseArguments(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " [-k K[,K...]] [--chars] [--stopwords FILE] [--passages T] [--simhash D]"
+             << " [--stream [--block-size BYTES]]"
+             << " [--trace LEVEL[:CATEGORY,...]] [--trace-file FILE] [file ...]" << endl;
+        return 1;
+    }
+    if (options.fileNames.empty()) {
+        options.fileNames = {"test-corpus/t1.txt", "test-corpus/t2.txt", "test-corpus/t3.txt", "test-corpus/t4.txt", "test-corpus/t5.txt", "test-corpus/t6.txt", "test-corpus/t7.txt", "test-corpus/t8.txt"};
+    }
 
 
     /*------ section (1):  For all other k-gram outputs without the Stopword-output------*/
@@ -268,13 +899,22 @@ int main(int argc, char* argv[]) {
     // printSimilarityMatrix(allHashedKGrams, fileNames);
 
 
-    /*------section (2): for 3-gram and the Stopword-output------*/
+    /*------section (2): k-gram and the Stopword-output------*/
 
-    // Pass 1: without stopwords removed
-    processStopwordsOutput(fileNames, k, false, "test-corpus/stopwords.txt");
-
-    // Pass 2: with stopwords removed
-    processStopwordsOutput(fileNames, k, true, "test-corpus/stopwords.txt");
+    // For every k: pass 1 without stopwords removed, pass 2 with stopwords removed,
+    // both derived from one tokenization of each file
+    if (options.passageThreshold >= 0 &&
+        (options.streamBlockSize > 0 || options.mode == ShingleMode::Characters || options.simhashDistance >= 0)) {
+        cerr << "Warning: --passages needs the word k-gram matrix over whole documents; ignored with --chars, --simhash and --stream." << endl;
+    }
+    if (options.simhashDistance >= 0 && options.streamBlockSize > 0) {
+        cerr << "Warning: --simhash needs the k-gram counts of whole documents; ignored with --stream." << endl;
+    }
+    if (options.streamBlockSize > 0) {
+        runStreamingSweep(options);
+    } else {
+        runParameterSweep(options);
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,121 @@
+/**
+ * SimHash Fingerprints and Hamming-Distance Index — implementation
+ * (see simhash.h)
+ */
+
+#include "simhash.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+using namespace std;
+
+// 64-bit finalizer (MurmurHash3 fmix64): k-gram hashes are only about 30 bits wide,
+// each SimHash bit needs an independent, evenly split vote
+static uint64_t mixFeature(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+uint64_t computeSimHash(vector<uint64_t>& hashes) {
+    sort(hashes.begin(), hashes.end());
+
+    array<double, 64> votes{};
+    for (size_t i = 0; i < hashes.size();) {
+        size_t run = i + 1;
+        while (run < hashes.size() && hashes[run] == hashes[i]) ++run;
+        double weight = 1.0 + log2(static_cast<double>(run - i));
+        uint64_t feature = mixFeature(hashes[i]);
+        for (int bit = 0; bit < 64; ++bit) {
+            votes[bit] += (feature >> bit) & 1 ? weight : -weight;
+        }
+        i = run;
+    }
+
+    uint64_t fingerprint = 0;
+    for (int bit = 0; bit < 64; ++bit) {
+        if (votes[bit] > 0) fingerprint |= uint64_t(1) << bit;
+    }
+    return fingerprint;
+}
+
+// ---------------------------
+// Permuted-table index
+// ---------------------------
+
+SimHashIndex::SimHashIndex(int maxDistance) : maxDistance(maxDistance) {
+    int blocks = maxDistance + 1;
+    for (int b = 0; b < blocks; ++b) {
+        blockStart.push_back(64 * b / blocks);
+        blockWidth.push_back(64 * (b + 1) / blocks - 64 * b / blocks);
+    }
+    tables.resize(blocks);
+}
+
+void SimHashIndex::add(uint32_t id, uint64_t fingerprint) {
+    for (size_t t = 0; t < tables.size(); ++t) {
+        tables[t].push_back({rotl(fingerprint, blockStart[t]), id});
+    }
+}
+
+void SimHashIndex::build() {
+    for (vector<Entry>& table : tables) {
+        sort(table.begin(), table.end(), [](const Entry& a, const Entry& b) {
+            return a.key != b.key ? a.key < b.key : a.id < b.id;
+        });
+    }
+}
+
+// A pair sharing an earlier block was already reported by that block's table
+bool SimHashIndex::matchesEarlierBlock(size_t table, uint64_t a, uint64_t b) const {
+    uint64_t rotatedA = rotr(a, blockStart[table]), rotatedB = rotr(b, blockStart[table]);
+    for (size_t t = 0; t < table; ++t) {
+        if (prefix(t, rotl(rotatedA, blockStart[t])) == prefix(t, rotl(rotatedB, blockStart[t]))) return true;
+    }
+    return false;
+}
+
+vector<uint32_t> SimHashIndex::query(uint64_t fingerprint) const {
+    vector<uint32_t> ids;
+    for (size_t t = 0; t < tables.size(); ++t) {
+        const vector<Entry>& table = tables[t];
+        uint64_t key = rotl(fingerprint, blockStart[t]);
+        auto it = lower_bound(table.begin(), table.end(), prefix(t, key),
+                              [&](const Entry& e, uint64_t p) { return prefix(t, e.key) < p; });
+        for (; it != table.end() && prefix(t, it->key) == prefix(t, key); ++it) {
+            if (hammingDistance(it->key, key) <= maxDistance) ids.push_back(it->id);
+        }
+    }
+    sort(ids.begin(), ids.end());
+    ids.erase(unique(ids.begin(), ids.end()), ids.end());
+    return ids;
+}
+
+vector<SimHashPair> SimHashIndex::nearPairs() const {
+    vector<SimHashPair> pairs;
+    for (size_t t = 0; t < tables.size(); ++t) {
+        const vector<Entry>& table = tables[t];
+        for (size_t runStart = 0; runStart < table.size();) {
+            size_t runEnd = runStart + 1;
+            while (runEnd < table.size() && prefix(t, table[runEnd].key) == prefix(t, table[runStart].key)) ++runEnd;
+
+            for (size_t x = runStart; x < runEnd; ++x) {
+                for (size_t y = x + 1; y < runEnd; ++y) {
+                    int distance = hammingDistance(table[x].key, table[y].key);
+                    if (distance > maxDistance || matchesEarlierBlock(t, table[x].key, table[y].key)) continue;
+                    pairs.push_back({min(table[x].id, table[y].id), max(table[x].id, table[y].id), distance});
+                }
+            }
+            runStart = runEnd;
+        }
+    }
+    sort(pairs.begin(), pairs.end(), [](const SimHashPair& a, const SimHashPair& b) {
+        return a.first != b.first ? a.first < b.first : a.second < b.second;
+    });
+    return pairs;
+}
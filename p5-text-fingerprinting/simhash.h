@@ -0,0 +1,83 @@
+/**
+ * SimHash Fingerprints and Hamming-Distance Index
+ * ===============================================
+ *
+ * A SimHash condenses a whole document into one 64-bit fingerprint. Every
+ * distinct k-gram votes on each bit with its weight: +w if its (mixed) hash has
+ * the bit set, -w if not. The fingerprint keeps the bits with a positive total.
+ * Documents that share most of their weighted k-grams end up a small Hamming
+ * distance apart, so near duplicates are found by comparing 8 bytes per
+ * document instead of two fingerprint sets.
+ *
+ * Weight of a k-gram occurring tf times: 1 + log2(tf), so a repeated line counts
+ * for more than a single occurrence but cannot outvote the rest of the document.
+ *
+ * The index finds every fingerprint within distance D of another without
+ * comparing all pairs (permuted tables, Manku et al. 2007). The 64 bits are cut
+ * into D + 1 blocks. Two fingerprints at most D bits apart agree exactly on at
+ * least one block (pigeonhole), so for each block there is a table sorted with
+ * that block rotated to the top. Candidates are then the entries that share the
+ * block value, one contiguous run per table.
+ */
+
+#ifndef SIMHASH_H
+#define SIMHASH_H
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Largest supported distance: blocks stay at least 8 bits wide
+const int SIMHASH_MAX_DISTANCE = 7;
+
+// SimHash of a document given the hash of each of its k-grams, in any order,
+// repeats included; `hashes` is sorted in place
+uint64_t computeSimHash(std::vector<uint64_t>& hashes);
+
+inline int hammingDistance(uint64_t a, uint64_t b) {
+    return std::popcount(a ^ b);
+}
+
+// Similarity in [0, 1] from the share of differing bits
+inline double simHashSimilarity(uint64_t a, uint64_t b) {
+    return 1.0 - hammingDistance(a, b) / 64.0;
+}
+
+struct SimHashPair {
+    uint32_t first, second; // document ids, first < second
+    int distance;
+};
+
+class SimHashIndex {
+public:
+    // maxDistance in [0, SIMHASH_MAX_DISTANCE]
+    explicit SimHashIndex(int maxDistance);
+
+    void add(uint32_t id, uint64_t fingerprint);
+
+    // Sort the tables; call once after the last add()
+    void build();
+
+    // Ids whose fingerprints are within maxDistance of `fingerprint`
+    std::vector<uint32_t> query(uint64_t fingerprint) const;
+
+    // Every pair within maxDistance, each reported once, ordered by (first, second)
+    std::vector<SimHashPair> nearPairs() const;
+
+private:
+    struct Entry {
+        uint64_t key; // fingerprint rotated so this table's block is on top
+        uint32_t id;
+    };
+
+    int maxDistance;
+    std::vector<int> blockStart; // first bit of each block, counted from the top
+    std::vector<int> blockWidth;
+    std::vector<std::vector<Entry>> tables;
+
+    uint64_t prefix(size_t table, uint64_t key) const { return key >> (64 - blockWidth[table]); }
+    bool matchesEarlierBlock(size_t table, uint64_t a, uint64_t b) const;
+};
+
+#endif // SIMHASH_H
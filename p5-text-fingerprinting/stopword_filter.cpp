@@ -0,0 +1,111 @@
+/**
+ * Perfect-Hash Stopword Filter — builder
+ * (see stopword_filter.h for the lookup)
+ *
+ * Hash-and-displace: keys are grouped into buckets of about four, and buckets
+ * are placed largest first, each trying seeds 0, 1, 2, ... until all its keys
+ * fall into free slots. Small buckets placed last find a seed quickly because
+ * they need few free slots. If some bucket finds no seed (or two keys share a
+ * full 64-bit hash) the whole build restarts with another salt.
+ */
+
+#include "stopword_filter.h"
+
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+#include <unordered_set>
+using namespace std;
+
+const uint32_t KEYS_PER_BUCKET = 4;
+const uint32_t MAX_SEED_ATTEMPTS = 1u << 16;
+const uint64_t MAX_SALT_ATTEMPTS = 64;
+
+// Try to place every key with one salt; fills seeds and slotOfKey on success
+static bool placeKeys(const vector<string_view>& keys, uint64_t salt, uint32_t bucketCount,
+                      vector<uint32_t>& seeds, vector<uint32_t>& slotOfKey) {
+    const uint32_t n = static_cast<uint32_t>(keys.size());
+    vector<uint64_t> hashes(n);
+    vector<vector<uint32_t>> buckets(bucketCount);
+    for (uint32_t i = 0; i < n; ++i) {
+        hashes[i] = stopwordHash(keys[i], salt);
+        buckets[stopwordReduce(hashes[i], bucketCount)].push_back(i);
+    }
+
+    vector<uint32_t> order(bucketCount);
+    iota(order.begin(), order.end(), 0);
+    stable_sort(order.begin(), order.end(),
+                [&](uint32_t a, uint32_t b) { return buckets[a].size() > buckets[b].size(); });
+
+    seeds.assign(bucketCount, 0);
+    slotOfKey.assign(n, 0);
+    vector<bool> taken(n, false);
+    vector<uint32_t> slots;
+
+    for (uint32_t b : order) {
+        const vector<uint32_t>& bucket = buckets[b];
+        if (bucket.empty()) break; // sorted by size: the rest are empty too
+
+        bool placed = false;
+        for (uint32_t seed = 0; seed < MAX_SEED_ATTEMPTS && !placed; ++seed) {
+            slots.clear();
+            placed = true;
+            for (uint32_t key : bucket) {
+                uint32_t slot = stopwordReduce(stopwordMix(hashes[key] + seed), n);
+                if (taken[slot] || find(slots.begin(), slots.end(), slot) != slots.end()) {
+                    placed = false;
+                    break;
+                }
+                slots.push_back(slot);
+            }
+            if (placed) {
+                seeds[b] = seed;
+                for (size_t i = 0; i < bucket.size(); ++i) {
+                    taken[slots[i]] = true;
+                    slotOfKey[bucket[i]] = slots[i];
+                }
+            }
+        }
+        if (!placed) return false;
+    }
+    return true;
+}
+
+StopwordFilter::StopwordFilter(const vector<string>& words) {
+    // Distinct words, in first-seen order so the table does not depend on hash-set iteration
+    vector<string_view> keys;
+    unordered_set<string_view> seen;
+    for (const string& word : words) {
+        if (seen.insert(word).second) keys.push_back(word);
+    }
+    if (keys.empty()) return;
+
+    const uint32_t n = static_cast<uint32_t>(keys.size());
+    const uint32_t bucketCount = (n + KEYS_PER_BUCKET - 1) / KEYS_PER_BUCKET;
+    vector<uint32_t> slotOfKey;
+
+    uint64_t salt = 0;
+    while (!placeKeys(keys, salt, bucketCount, seedStorage, slotOfKey)) {
+        if (++salt == MAX_SALT_ATTEMPTS) {
+            throw runtime_error("cannot build a perfect hash over the stopword list");
+        }
+    }
+
+    // Copy the keys into one buffer, in slot order; the views stay valid when the filter is moved
+    vector<string_view> bySlot(n);
+    size_t totalChars = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+        bySlot[slotOfKey[i]] = keys[i];
+        totalChars += keys[i].size();
+    }
+    keyChars.resize(totalChars);
+    keyStorage.reserve(n);
+    size_t offset = 0;
+    for (string_view key : bySlot) {
+        copy(key.begin(), key.end(), keyChars.begin() + offset);
+        keyStorage.emplace_back(keyChars.data() + offset, key.size());
+        offset += key.size();
+    }
+
+    table = PerfectHashView{seedStorage.data(), bucketCount, keyStorage.data(), n, salt};
+}
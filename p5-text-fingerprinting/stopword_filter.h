@@ -0,0 +1,136 @@
+/**
+ * Perfect-Hash Stopword Filter
+ * ============================
+ *
+ * Stopword membership is tested once per token, so it is kept to a couple of
+ * multiplies and one key comparison, with no allocation and no probing loop.
+ *
+ * The table is a minimal perfect hash built with hash-and-displace (CHD):
+ *   h      = stopwordHash(token, salt)          one or two word loads
+ *   bucket = reduce(h, bucketCount)
+ *   slot   = reduce(mix(h + seeds[bucket]), keyCount)
+ * The builder picks one seed per bucket so that every stopword lands in its own
+ * slot; a lookup then compares the token with the single key in its slot.
+ *
+ * Two sources share the same lookup:
+ *   - the built-in list, generated at build time from test-corpus/stopwords.txt
+ *     into a constexpr table (tools/gen_stopword_table.cpp -> stopword_table.h),
+ *   - user-supplied lists, built at run time by StopwordFilter(words).
+ */
+
+#ifndef STOPWORD_FILTER_H
+#define STOPWORD_FILTER_H
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Little-endian load of `Bytes` bytes: one machine load at run time, byte by
+// byte in constant evaluation (the generated table is checked that way)
+template <int Bytes>
+constexpr uint64_t stopwordLoad(const char* p) {
+    if constexpr (std::endian::native == std::endian::little && (Bytes == 4 || Bytes == 8)) {
+        if (!std::is_constant_evaluated()) {
+            std::conditional_t<Bytes == 4, uint32_t, uint64_t> v;
+            std::memcpy(&v, p, Bytes);
+            return v;
+        }
+    }
+    uint64_t v = 0;
+    for (int i = 0; i < Bytes; ++i) {
+        v |= static_cast<uint64_t>(static_cast<unsigned char>(p[i])) << (8 * i);
+    }
+    return v;
+}
+
+// 64-bit finalizer (MurmurHash3 fmix64)
+constexpr uint64_t stopwordMix(uint64_t x) {
+    x ^= x >> 33;
+    x *= 0xFF51AFD7ED558CCDULL;
+    x ^= x >> 33;
+    x *= 0xC4CEB9FE1A85EC53ULL;
+    x ^= x >> 33;
+    return x;
+}
+
+// Word-at-a-time hash: tokens of up to 8 bytes (nearly all words) take two
+// overlapping loads and one finalizer instead of a per-byte loop
+constexpr uint64_t stopwordHash(std::string_view s, uint64_t salt) {
+    const char* p = s.data();
+    const size_t n = s.size();
+    uint64_t v = 0;
+    if (n >= 8) {
+        for (size_t i = 0; i + 8 < n; i += 8) {
+            v = stopwordMix(v ^ stopwordLoad<8>(p + i));
+        }
+        v ^= stopwordLoad<8>(p + n - 8);
+    } else if (n >= 4) {
+        v = stopwordLoad<4>(p) | (stopwordLoad<4>(p + n - 4) << 32);
+    } else if (n > 0) {
+        v = stopwordLoad<1>(p) | (stopwordLoad<1>(p + n / 2) << 8) | (stopwordLoad<1>(p + n - 1) << 16);
+    }
+    return stopwordMix(v ^ salt ^ (n * 0x9E3779B97F4A7C15ULL));
+}
+
+// Map a 64-bit hash to [0, n) without a division
+constexpr uint32_t stopwordReduce(uint64_t x, uint32_t n) {
+    return static_cast<uint32_t>(((x >> 32) * n) >> 32);
+}
+
+// Non-owning view of a perfect-hash table; usable in constant expressions
+struct PerfectHashView {
+    const uint32_t* seeds = nullptr;
+    uint32_t bucketCount = 0;
+    const std::string_view* keys = nullptr;
+    uint32_t keyCount = 0;
+    uint64_t salt = 0;
+
+    constexpr bool contains(std::string_view token) const {
+        if (keyCount == 0) return false;
+        uint64_t h = stopwordHash(token, salt);
+        uint32_t slot = stopwordReduce(stopwordMix(h + seeds[stopwordReduce(h, bucketCount)]), keyCount);
+        return keys[slot] == token;
+    }
+};
+
+class StopwordFilter {
+public:
+    // Empty filter: nothing is a stopword
+    StopwordFilter() = default;
+
+    // Build a minimal perfect hash over `words` (duplicates are ignored)
+    explicit StopwordFilter(const std::vector<std::string>& words);
+
+    // Filter over a table that lives elsewhere (e.g. the generated constexpr table)
+    explicit StopwordFilter(const PerfectHashView& table) : table(table) {}
+
+    // The views point into this object's buffers: moving keeps them valid, copying would not
+    StopwordFilter(const StopwordFilter&) = delete;
+    StopwordFilter& operator=(const StopwordFilter&) = delete;
+    StopwordFilter(StopwordFilter&& other) noexcept { *this = std::move(other); }
+    StopwordFilter& operator=(StopwordFilter&& other) noexcept {
+        table = std::exchange(other.table, PerfectHashView{});
+        seedStorage = std::move(other.seedStorage);
+        keyChars = std::move(other.keyChars);
+        keyStorage = std::move(other.keyStorage);
+        return *this;
+    }
+
+    bool contains(std::string_view token) const { return table.contains(token); }
+    bool empty() const { return table.keyCount == 0; }
+    size_t size() const { return table.keyCount; }
+    const PerfectHashView& view() const { return table; }
+
+private:
+    PerfectHashView table;
+    std::vector<uint32_t> seedStorage;
+    std::vector<char> keyChars;
+    std::vector<std::string_view> keyStorage;
+};
+
+#endif // STOPWORD_FILTER_H
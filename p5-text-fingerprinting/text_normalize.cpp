@@ -0,0 +1,253 @@
+/**
+ * Single-Pass Text Normalization Kernel — implementation
+ * (see text_normalize.h)
+ *
+ * All kernels share one invariant: the write position never passes the read
+ * position, because the output is never longer than the input consumed so
+ * far. A vector block is loaded before anything is stored over it, so a
+ * full-width store of a completely consumed block is safe in place; a
+ * partially consumed block is staged and only its consumed prefix copied.
+ *
+ * The vector kernels copy the longest verbatim prefix of each block and
+ * restart the next block right after it (unaligned), so a newline or a
+ * double space costs one short scalar skip instead of a whole scalar block.
+ *
+ * Text with no byte >= 0x80 (checked 16 bytes at a time) never leaves the
+ * ASCII kernels. Otherwise the kernels run over the ASCII stretches between
+ * non-ASCII characters, which are handled one code point at a time.
+ */
+
+#include "text_normalize.h"
+#include "utf8.h"
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#include <immintrin.h>
+#define TEXT_NORMALIZE_X86 1
+#endif
+
+#if defined(TEXT_NORMALIZE_X86) && (defined(__GNUC__) || defined(__clang__))
+#define TEXT_NORMALIZE_AVX2 1
+#endif
+
+using namespace std;
+
+// Output position and whether a space is owed before the next written character
+struct NormalizeState {
+    size_t written = 0;
+    bool pendingSpace = false;
+};
+
+static inline bool isSpaceByte(unsigned char c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline void flushPendingSpace(char* data, NormalizeState& st) {
+    if (st.pendingSpace) {
+        data[st.written++] = ' ';
+        st.pendingSpace = false;
+    }
+}
+
+// Byte-at-a-time state machine over data[from, to)
+static void normalizeScalarRange(char* data, size_t from, size_t to, NormalizeState& st) {
+    for (size_t r = from; r < to; ++r) {
+        unsigned char c = data[r];
+        if (isSpaceByte(c)) {
+            if (st.written > 0) st.pendingSpace = true; // leading whitespace is dropped
+            continue;
+        }
+        flushPendingSpace(data, st);
+        data[st.written++] = (c >= 'A' && c <= 'Z') ? static_cast<char>(c + ('a' - 'A')) : static_cast<char>(c);
+    }
+}
+
+// Consume a whitespace run starting at data[r]; it becomes at most one pending space
+static size_t skipWhitespaceRun(const char* data, size_t r, size_t size, NormalizeState& st) {
+    while (r < size && isSpaceByte(data[r])) ++r;
+    if (st.written > 0) st.pendingSpace = true;
+    return r;
+}
+
+// Length of the block prefix that can be copied (lowercased) verbatim: it ends at the
+// first control whitespace, the first space followed by another space, or at once if
+// the block starts with a space that continues a run or leads the text
+static inline unsigned verbatimPrefix(uint32_t spaces, uint32_t controls, const NormalizeState& st, unsigned width) {
+    uint32_t stops = controls | (spaces & (spaces >> 1));
+    if ((spaces & 1) && (st.pendingSpace || st.written == 0)) stops |= 1;
+    return stops ? countr_zero(stops) : width;
+}
+
+// Account for a verbatim prefix just stored at data[written]. A space at its end is
+// held back: it may start a run or end the text.
+static inline void advancePastPrefix(unsigned prefix, uint32_t spaces, NormalizeState& st) {
+    bool endsWithSpace = (spaces >> (prefix - 1)) & 1;
+    st.written += endsWithSpace ? prefix - 1 : prefix;
+    st.pendingSpace = endsWithSpace;
+}
+
+#ifdef TEXT_NORMALIZE_X86
+static void normalizeSSE2(char* data, size_t from, size_t size, NormalizeState& st) {
+    const __m128i beforeA = _mm_set1_epi8('A' - 1), afterZ = _mm_set1_epi8('Z' + 1);
+    const __m128i beforeTab = _mm_set1_epi8('\t' - 1), afterCR = _mm_set1_epi8('\r' + 1);
+    const __m128i space = _mm_set1_epi8(' '), caseBit = _mm_set1_epi8(0x20);
+
+    size_t r = from;
+    while (r + 16 <= size) {
+        __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + r));
+        // Signed compares: bytes >= 0x80 are negative and never match either range
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(block, beforeA), _mm_cmplt_epi8(block, afterZ));
+        __m128i control = _mm_and_si128(_mm_cmpgt_epi8(block, beforeTab), _mm_cmplt_epi8(block, afterCR));
+        uint32_t spaces = _mm_movemask_epi8(_mm_cmpeq_epi8(block, space));
+        uint32_t controls = _mm_movemask_epi8(control);
+
+        unsigned prefix = verbatimPrefix(spaces, controls, st, 16);
+        if (prefix == 0) {
+            r = skipWhitespaceRun(data, r, size, st);
+            continue;
+        }
+        __m128i lowered = _mm_add_epi8(block, _mm_and_si128(upper, caseBit));
+        flushPendingSpace(data, st);
+        if (prefix == 16) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(data + st.written), lowered);
+        } else {
+            // A full store would clobber the unread bytes after the prefix
+            alignas(16) char staged[16];
+            _mm_store_si128(reinterpret_cast<__m128i*>(staged), lowered);
+            memcpy(data + st.written, staged, prefix);
+        }
+        advancePastPrefix(prefix, spaces, st);
+        r += prefix;
+    }
+    normalizeScalarRange(data, r, size, st);
+}
+#endif
+
+#ifdef TEXT_NORMALIZE_AVX2
+__attribute__((target("avx2")))
+static void normalizeAVX2(char* data, size_t from, size_t size, NormalizeState& st) {
+    const __m256i beforeA = _mm256_set1_epi8('A' - 1), afterZ = _mm256_set1_epi8('Z' + 1);
+    const __m256i beforeTab = _mm256_set1_epi8('\t' - 1), afterCR = _mm256_set1_epi8('\r' + 1);
+    const __m256i space = _mm256_set1_epi8(' '), caseBit = _mm256_set1_epi8(0x20);
+
+    size_t r = from;
+    while (r + 32 <= size) {
+        __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + r));
+        __m256i upper = _mm256_and_si256(_mm256_cmpgt_epi8(block, beforeA), _mm256_cmpgt_epi8(afterZ, block));
+        __m256i control = _mm256_and_si256(_mm256_cmpgt_epi8(block, beforeTab), _mm256_cmpgt_epi8(afterCR, block));
+        uint32_t spaces = static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, space)));
+        uint32_t controls = static_cast<uint32_t>(_mm256_movemask_epi8(control));
+
+        unsigned prefix = verbatimPrefix(spaces, controls, st, 32);
+        if (prefix == 0) {
+            r = skipWhitespaceRun(data, r, size, st);
+            continue;
+        }
+        __m256i lowered = _mm256_add_epi8(block, _mm256_and_si256(upper, caseBit));
+        flushPendingSpace(data, st);
+        if (prefix == 32) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(data + st.written), lowered);
+        } else {
+            alignas(32) char staged[32];
+            _mm256_store_si256(reinterpret_cast<__m256i*>(staged), lowered);
+            memcpy(data + st.written, staged, prefix);
+        }
+        advancePastPrefix(prefix, spaces, st);
+        r += prefix;
+    }
+    normalizeScalarRange(data, r, size, st);
+}
+#endif
+
+NormalizeKernel bestNormalizeKernel() {
+#ifdef TEXT_NORMALIZE_AVX2
+    static const bool hasAVX2 = __builtin_cpu_supports("avx2");
+    if (hasAVX2) return NormalizeKernel::AVX2;
+#endif
+#ifdef TEXT_NORMALIZE_X86
+    return NormalizeKernel::SSE2; // part of the x86-64 baseline
+#else
+    return NormalizeKernel::Scalar;
+#endif
+}
+
+// Normalize the ASCII bytes data[from, to) with one kernel
+static void normalizeAsciiRange(char* data, size_t from, size_t to, NormalizeKernel kernel, NormalizeState& st) {
+    switch (kernel) {
+#ifdef TEXT_NORMALIZE_AVX2
+        case NormalizeKernel::AVX2: normalizeAVX2(data, from, to, st); break;
+#endif
+#ifdef TEXT_NORMALIZE_X86
+        case NormalizeKernel::SSE2: normalizeSSE2(data, from, to, st); break;
+#endif
+        default: normalizeScalarRange(data, from, to, st); break;
+    }
+}
+
+// Position of the first byte >= 0x80 in data[from, size), or size
+static size_t findNonAscii(const char* data, size_t from, size_t size) {
+    size_t r = from;
+#ifdef TEXT_NORMALIZE_X86
+    for (; r + 16 <= size; r += 16) {
+        uint32_t high = _mm_movemask_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(data + r)));
+        if (high) return r + countr_zero(high);
+    }
+#endif
+    while (r < size && static_cast<unsigned char>(data[r]) < 0x80) ++r;
+    return r;
+}
+
+bool containsNonAscii(string_view text) {
+    return findNonAscii(text.data(), 0, text.size()) != text.size();
+}
+
+// Text with high bytes: ASCII stretches still go through the vector kernel; each
+// non-ASCII character is decoded, case-folded (never growing, so still in place)
+// or collapsed as whitespace. Invalid bytes are kept as they are.
+static void normalizeUtf8(char* data, size_t size, NormalizeKernel kernel, NormalizeState& st) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    size_t r = 0;
+    while (r < size) {
+        size_t next = findNonAscii(data, r, size);
+        normalizeAsciiRange(data, r, next, kernel, st);
+        r = next;
+
+        while (r < size && bytes[r] >= 0x80) {
+            char32_t cp;
+            int length = decodeUtf8(bytes + r, size - r, cp);
+            if (length == 0) {
+                flushPendingSpace(data, st);
+                data[st.written++] = data[r++];
+                continue;
+            }
+            r += length;
+            if (isUnicodeSpace(cp)) {
+                if (st.written > 0) st.pendingSpace = true;
+                continue;
+            }
+            flushPendingSpace(data, st);
+            st.written += encodeUtf8(foldCase(cp), data + st.written);
+        }
+    }
+}
+
+void normalizeWhitespaceAndCase(string& text, NormalizeKernel kernel) {
+    // Never run a kernel the CPU lacks
+    if (kernel > bestNormalizeKernel()) kernel = bestNormalizeKernel();
+
+    NormalizeState st;
+    if (containsNonAscii(text)) {
+        normalizeUtf8(text.data(), text.size(), kernel, st);
+    } else {
+        normalizeAsciiRange(text.data(), 0, text.size(), kernel, st);
+    }
+    text.resize(st.written); // a held-back trailing space is simply never written
+}
+
+void normalizeWhitespaceAndCase(string& text) {
+    normalizeWhitespaceAndCase(text, bestNormalizeKernel());
+}
@@ -0,0 +1,44 @@
+/**
+ * Single-Pass Text Normalization Kernel
+ * =====================================
+ *
+ * Does in one pass, in place, what normalizeText() used to do with a tolower
+ * transform and three regex_replace calls:
+ *   - lowercases letters: ASCII, and in UTF-8 text also Latin, Greek, Cyrillic,
+ *     Armenian and fullwidth letters (see utf8.h); invalid UTF-8 bytes are kept,
+ *   - collapses every run of whitespace (space, \t, \n, \v, \f, \r, and in
+ *     UTF-8 text also no-break and other Unicode spaces) to one space,
+ *   - drops leading and trailing whitespace.
+ *
+ * Blocks of 32 (AVX2) or 16 (SSE2) bytes are lowercased and stored with a
+ * handful of vector instructions up to the first byte that needs collapsing
+ * (a newline, tab or other control whitespace, or a run of spaces). Only
+ * that whitespace run is then skipped byte by byte, and the next block is
+ * loaded unaligned right after it, so a block is never handed whole to the
+ * byte-at-a-time state machine, which only handles the final partial block.
+ * The AVX2 kernel is chosen at run time when the CPU supports it; the scalar
+ * kernel is used on other architectures. Pure-ASCII text takes only this
+ * path; in UTF-8 text the kernels handle the ASCII stretches between
+ * non-ASCII characters.
+ */
+
+#ifndef TEXT_NORMALIZE_H
+#define TEXT_NORMALIZE_H
+
+#include <string>
+#include <string_view>
+
+enum class NormalizeKernel { Scalar, SSE2, AVX2 };
+
+// Normalize `text` in place with the best kernel available on this CPU
+void normalizeWhitespaceAndCase(std::string& text);
+
+// Same, forcing one kernel (used to cross-check and benchmark the kernels)
+void normalizeWhitespaceAndCase(std::string& text, NormalizeKernel kernel);
+
+NormalizeKernel bestNormalizeKernel();
+
+// True if any byte is >= 0x80 (vectorized scan); pure-ASCII text can skip UTF-8 handling
+bool containsNonAscii(std::string_view text);
+
+#endif // TEXT_NORMALIZE_H
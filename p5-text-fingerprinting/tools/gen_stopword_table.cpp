@@ -0,0 +1,105 @@
+/**
+ * Stopword Table Generator
+ * ========================
+ *
+ * Build-time tool: reads a whitespace-separated stopword list, builds the
+ * minimal perfect hash with the same code the program uses at run time, and
+ * writes it out as a header of constexpr arrays:
+ *
+ *   gen_stopword_table test-corpus/stopwords.txt generated/stopword_table.h
+ *
+ * The header defines `builtinStopwords`, a PerfectHashView over the tables,
+ * so the default stopword list costs no file read and no table build.
+ */
+
+#include "../stopword_filter.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+using namespace std;
+
+// C++ string literal for a stopword (backslashes, quotes and non-printables escaped)
+static string quoteLiteral(string_view word) {
+    string quoted = "\"";
+    for (unsigned char c : word) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7F) {
+            // Octal escapes end after three digits, so a following character cannot extend them
+            quoted += '\\';
+            quoted += static_cast<char>('0' + (c >> 6));
+            quoted += static_cast<char>('0' + ((c >> 3) & 7));
+            quoted += static_cast<char>('0' + (c & 7));
+        } else {
+            quoted += static_cast<char>(c);
+        }
+    }
+    return quoted + "\"";
+}
+
+int main(int argc, char* argv[]) {
+    if (argc != 3) {
+        cerr << "Usage: " << argv[0] << " STOPWORDS_FILE OUTPUT_HEADER" << endl;
+        return 1;
+    }
+
+    ifstream input(argv[1]);
+    if (!input.is_open()) {
+        cerr << "Error opening stopwords file: " << argv[1] << endl;
+        return 1;
+    }
+    vector<string> words;
+    string word;
+    while (input >> word) {
+        words.push_back(word);
+    }
+
+    StopwordFilter filter(words);
+    const PerfectHashView& table = filter.view();
+
+    ofstream out(argv[2]);
+    if (!out.is_open()) {
+        cerr << "Error writing " << argv[2] << endl;
+        return 1;
+    }
+    out << "// Generated by gen_stopword_table from " << filesystem::path(argv[1]).filename().string() << " -- do not edit\n"
+        << "#ifndef STOPWORD_TABLE_H\n"
+        << "#define STOPWORD_TABLE_H\n\n"
+        << "#include \"stopword_filter.h\"\n\n";
+
+    // Arrays cannot be empty, so an empty list still gets one unused entry
+    out << "inline constexpr uint32_t builtinStopwordSeeds[] = {";
+    for (uint32_t b = 0; b < table.bucketCount; ++b) {
+        out << (b % 16 == 0 ? "\n    " : " ") << table.seeds[b] << ",";
+    }
+    if (table.bucketCount == 0) out << "0";
+    out << "\n};\n\n";
+
+    out << "inline constexpr std::string_view builtinStopwordKeys[] = {";
+    for (uint32_t i = 0; i < table.keyCount; ++i) {
+        out << "\n    " << quoteLiteral(table.keys[i]) << ",";
+    }
+    if (table.keyCount == 0) out << "\"\"";
+    out << "\n};\n\n";
+
+    out << "inline constexpr PerfectHashView builtinStopwords{\n"
+        << "    builtinStopwordSeeds, " << table.bucketCount << ",\n"
+        << "    builtinStopwordKeys, " << table.keyCount << ",\n"
+        << "    " << table.salt << "ULL};\n\n";
+
+    // Every listed word must be found, checked by the compiler
+    for (uint32_t i = 0; i < table.keyCount; ++i) {
+        out << "static_assert(builtinStopwords.contains(" << quoteLiteral(table.keys[i]) << "));\n";
+    }
+    out << "\n#endif // STOPWORD_TABLE_H\n";
+
+    if (!out) {
+        cerr << "Error writing " << argv[2] << endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+/**
+ * UTF-8 Decoding, Case Folding and Character Classes — tables
+ * (see utf8.h)
+ */
+
+#include "utf8.h"
+
+#include <algorithm>
+#include <array>
+#include <iterator>
+using namespace std;
+
+// ---------------------------
+// Case folding
+// ---------------------------
+
+// Lowercase partner of a two-byte code point (U+0080..U+07FF), by rule
+constexpr char32_t foldTwoByte(char32_t cp) {
+    auto evenUpper = [&](char32_t first, char32_t last) { return cp >= first && cp <= last && cp % 2 == 0; };
+    auto oddUpper = [&](char32_t first, char32_t last) { return cp >= first && cp <= last && cp % 2 == 1; };
+
+    // Latin-1 Supplement and Latin Extended-A/B
+    if (cp >= 0xC0 && cp <= 0xDE && cp != 0xD7) return cp + 0x20;
+    if (evenUpper(0x100, 0x12F) || evenUpper(0x132, 0x137) || evenUpper(0x14A, 0x177)) return cp + 1;
+    if (oddUpper(0x139, 0x148) || oddUpper(0x179, 0x17E)) return cp + 1;
+    if (cp == 0x130) return 'i';
+    if (cp == 0x178) return 0xFF;
+    if (cp == 0x1C4 || cp == 0x1C7 || cp == 0x1CA || cp == 0x1F1) return cp + 2;
+    if (cp == 0x1C5 || cp == 0x1C8 || cp == 0x1CB || cp == 0x1F2) return cp + 1;
+    if (oddUpper(0x1CD, 0x1DC)) return cp + 1;
+    if (evenUpper(0x1DE, 0x1EF) || evenUpper(0x1F8, 0x21F) || evenUpper(0x222, 0x233)) return cp + 1;
+
+    // Greek
+    if (cp == 0x386) return 0x3AC;
+    if (cp >= 0x388 && cp <= 0x38A) return cp + 37;
+    if (cp == 0x38C) return 0x3CC;
+    if (cp == 0x38E || cp == 0x38F) return cp + 63;
+    if ((cp >= 0x391 && cp <= 0x3A1) || (cp >= 0x3A3 && cp <= 0x3AB)) return cp + 0x20;
+    if (cp == 0x3C2) return 0x3C3; // final sigma folds to sigma
+
+    // Cyrillic
+    if (cp >= 0x400 && cp <= 0x40F) return cp + 0x50;
+    if (cp >= 0x410 && cp <= 0x42F) return cp + 0x20;
+    if (evenUpper(0x460, 0x481) || evenUpper(0x48A, 0x4BF) || evenUpper(0x4D0, 0x52F)) return cp + 1;
+    if (cp == 0x4C0) return 0x4CF;
+    if (oddUpper(0x4C1, 0x4CE)) return cp + 1;
+
+    // Armenian
+    if (cp >= 0x531 && cp <= 0x556) return cp + 0x30;
+    return cp;
+}
+
+constexpr array<char16_t, 0x800> makeTwoByteFoldTable() {
+    array<char16_t, 0x800> table{};
+    for (char32_t cp = 0; cp < 0x800; ++cp) {
+        bool asciiUpper = cp >= 'A' && cp <= 'Z';
+        table[cp] = static_cast<char16_t>(cp < 0x80 ? (asciiUpper ? cp + 0x20 : cp) : foldTwoByte(cp));
+    }
+    return table;
+}
+constinit const array<char16_t, 0x800> twoByteFoldTable = makeTwoByteFoldTable();
+
+// In-place folding relies on this
+constexpr bool foldingNeverGrows() {
+    for (char32_t cp = 0; cp < 0x800; ++cp) {
+        if (utf8Length(makeTwoByteFoldTable()[cp]) > utf8Length(cp)) return false;
+    }
+    return true;
+}
+static_assert(foldingNeverGrows());
+
+char32_t foldCaseAbove2Byte(char32_t cp) {
+    // Latin Extended Additional (Vietnamese and others)
+    if ((cp >= 0x1E00 && cp <= 0x1E95) || (cp >= 0x1EA0 && cp <= 0x1EFF)) return cp % 2 == 0 ? cp + 1 : cp;
+    if (cp == 0x1E9E) return 0xDF; // capital sharp s
+    // Fullwidth Latin
+    if (cp >= 0xFF21 && cp <= 0xFF3A) return cp + 0x20;
+    return cp;
+}
+
+// ---------------------------
+// Word segmentation classes
+// ---------------------------
+
+struct ClassRange {
+    char32_t first, last;
+    CharClass cls;
+};
+
+// Letters, digits and combining marks of the scripts below U+0800
+constexpr ClassRange twoByteWordRanges[] = {
+    {'0', '9', CharClass::Word},       {'A', 'Z', CharClass::Word},       {'a', 'z', CharClass::Word},
+    {0xAA, 0xAA, CharClass::Word},     {0xB5, 0xB5, CharClass::Word},     {0xBA, 0xBA, CharClass::Word},
+    {0xC0, 0xD6, CharClass::Word},     {0xD8, 0xF6, CharClass::Word},     {0xF8, 0x2C1, CharClass::Word},
+    {0x2C6, 0x2D1, CharClass::Word},   {0x2E0, 0x2E4, CharClass::Word},   {0x300, 0x373, CharClass::Word},
+    {0x376, 0x377, CharClass::Word},   {0x37A, 0x37D, CharClass::Word},   {0x37F, 0x37F, CharClass::Word},
+    {0x386, 0x386, CharClass::Word},   {0x388, 0x3F5, CharClass::Word},   {0x3F7, 0x481, CharClass::Word},
+    {0x483, 0x52F, CharClass::Word},   {0x531, 0x556, CharClass::Word},   {0x559, 0x559, CharClass::Word},
+    {0x560, 0x588, CharClass::Word},   {0x591, 0x5BD, CharClass::Word},   {0x5BF, 0x5BF, CharClass::Word},
+    {0x5C1, 0x5C2, CharClass::Word},   {0x5C4, 0x5C5, CharClass::Word},   {0x5C7, 0x5C7, CharClass::Word},
+    {0x5D0, 0x5EA, CharClass::Word},   {0x5EF, 0x5F2, CharClass::Word},   {0x610, 0x61A, CharClass::Word},
+    {0x620, 0x669, CharClass::Word},   {0x66E, 0x6D3, CharClass::Word},   {0x6D5, 0x6DC, CharClass::Word},
+    {0x6DF, 0x6E8, CharClass::Word},   {0x6EA, 0x6FC, CharClass::Word},   {0x6FF, 0x6FF, CharClass::Word},
+    {0x710, 0x74A, CharClass::Word},   {0x74D, 0x7B1, CharClass::Word},   {0x7C0, 0x7F5, CharClass::Word},
+};
+
+// Higher code points, sorted; anything not listed is a separator
+constexpr ClassRange higherRanges[] = {
+    {0x0900, 0x0963, CharClass::Word},      // Devanagari (0964/0965 are dandas)
+    {0x0966, 0x0DFF, CharClass::Word},      // Devanagari digits .. Sinhala
+    {0x0E01, 0x0E3A, CharClass::Word},      // Thai
+    {0x0E40, 0x0E4E, CharClass::Word},
+    {0x0E50, 0x0E59, CharClass::Word},
+    {0x0E80, 0x0EFF, CharClass::Word},      // Lao
+    {0x10A0, 0x10FF, CharClass::Word},      // Georgian
+    {0x1100, 0x11FF, CharClass::Word},      // Hangul Jamo
+    {0x1E00, 0x1FBC, CharClass::Word},      // Latin Extended Additional, Greek Extended
+    {0x1FC2, 0x1FCC, CharClass::Word},
+    {0x1FD0, 0x1FDB, CharClass::Word},
+    {0x1FE0, 0x1FEC, CharClass::Word},
+    {0x1FF2, 0x1FFC, CharClass::Word},
+    {0x3005, 0x3007, CharClass::Ideograph}, // iteration mark, closing mark, ideographic zero
+    {0x3041, 0x309F, CharClass::Ideograph}, // Hiragana
+    {0x30A1, 0x30FA, CharClass::Ideograph}, // Katakana
+    {0x30FC, 0x30FF, CharClass::Ideograph},
+    {0x3131, 0x318E, CharClass::Word},      // Hangul Compatibility Jamo
+    {0x3400, 0x4DBF, CharClass::Ideograph}, // CJK Extension A
+    {0x4E00, 0x9FFF, CharClass::Ideograph}, // CJK Unified Ideographs
+    {0xAC00, 0xD7A3, CharClass::Word},      // Hangul syllables
+    {0xF900, 0xFAFF, CharClass::Ideograph}, // CJK Compatibility Ideographs
+    {0xFF10, 0xFF19, CharClass::Word},      // fullwidth digits and Latin
+    {0xFF21, 0xFF3A, CharClass::Word},
+    {0xFF41, 0xFF5A, CharClass::Word},
+    {0xFF66, 0xFF9F, CharClass::Ideograph}, // halfwidth Katakana
+    {0x20000, 0x3134F, CharClass::Ideograph}, // CJK Extensions B..G
+};
+
+constexpr array<CharClass, 0x800> makeTwoByteClassTable() {
+    array<CharClass, 0x800> table{};
+    for (const ClassRange& range : twoByteWordRanges) {
+        for (char32_t cp = range.first; cp <= range.last; ++cp) table[cp] = range.cls;
+    }
+    return table;
+}
+constexpr array<CharClass, 0x800> twoByteClass = makeTwoByteClassTable();
+
+CharClass classifyCodePoint(char32_t cp) {
+    if (cp < 0x800) return twoByteClass[cp];
+    auto it = upper_bound(begin(higherRanges), end(higherRanges), cp,
+                          [](char32_t value, const ClassRange& range) { return value < range.first; });
+    if (it == begin(higherRanges)) return CharClass::Separator;
+    --it;
+    return cp <= it->last ? it->cls : CharClass::Separator;
+}
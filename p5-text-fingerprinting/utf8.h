@@ -0,0 +1,106 @@
+/**
+ * UTF-8 Decoding, Case Folding and Character Classes
+ * ==================================================
+ *
+ * The small amount of Unicode knowledge the normalizer and the tokenizer need
+ * for non-ASCII text:
+ *   - strict UTF-8 decoding (overlong forms, surrogates and code points past
+ *     U+10FFFF are rejected) and encoding,
+ *   - simple case folding for Latin, Greek, Cyrillic and Armenian letters and
+ *     fullwidth Latin; a folded character never encodes longer than the
+ *     original, so folding can be done in place,
+ *   - the Unicode whitespace characters that collapse like ASCII whitespace,
+ *   - a word-segmentation class per code point: part of a word, a separator,
+ *     or an ideograph (Han and kana), which forms a one-character token since
+ *     those scripts do not put spaces between words.
+ *
+ * Code points below U+0800 (everything up to Arabic) use lookup tables;
+ * higher code points use a short sorted range table.
+ */
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+// Decode the sequence at p (avail bytes readable); returns its length, or 0 if invalid
+inline int decodeUtf8(const unsigned char* p, size_t avail, char32_t& cp) {
+    unsigned char c = p[0];
+    if (c < 0x80) {
+        cp = c;
+        return 1;
+    }
+    auto cont = [&](size_t i) { return i < avail && (p[i] & 0xC0) == 0x80; };
+    if (c >= 0xC2 && c <= 0xDF) {
+        if (!cont(1)) return 0;
+        cp = ((c & 0x1Fu) << 6) | (p[1] & 0x3Fu);
+        return 2;
+    }
+    if (c >= 0xE0 && c <= 0xEF) {
+        if (!cont(1) || !cont(2)) return 0;
+        if (c == 0xE0 && p[1] < 0xA0) return 0; // overlong
+        if (c == 0xED && p[1] > 0x9F) return 0; // surrogate
+        cp = ((c & 0x0Fu) << 12) | ((p[1] & 0x3Fu) << 6) | (p[2] & 0x3Fu);
+        return 3;
+    }
+    if (c >= 0xF0 && c <= 0xF4) {
+        if (!cont(1) || !cont(2) || !cont(3)) return 0;
+        if (c == 0xF0 && p[1] < 0x90) return 0; // overlong
+        if (c == 0xF4 && p[1] > 0x8F) return 0; // past U+10FFFF
+        cp = ((c & 0x07u) << 18) | ((p[1] & 0x3Fu) << 12) | ((p[2] & 0x3Fu) << 6) | (p[3] & 0x3Fu);
+        return 4;
+    }
+    return 0;
+}
+
+constexpr int utf8Length(char32_t cp) {
+    return cp < 0x80 ? 1 : cp < 0x800 ? 2 : cp < 0x10000 ? 3 : 4;
+}
+
+// Encode a valid code point at out; returns the number of bytes written
+inline int encodeUtf8(char32_t cp, char* out) {
+    if (cp < 0x80) {
+        out[0] = static_cast<char>(cp);
+        return 1;
+    }
+    if (cp < 0x800) {
+        out[0] = static_cast<char>(0xC0 | (cp >> 6));
+        out[1] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 2;
+    }
+    if (cp < 0x10000) {
+        out[0] = static_cast<char>(0xE0 | (cp >> 12));
+        out[1] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (cp & 0x3F));
+        return 3;
+    }
+    out[0] = static_cast<char>(0xF0 | (cp >> 18));
+    out[1] = static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+    out[2] = static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+    out[3] = static_cast<char>(0x80 | (cp & 0x3F));
+    return 4;
+}
+
+// Lowercase of every code point below U+0800, and the rules for the rest
+extern const std::array<char16_t, 0x800> twoByteFoldTable;
+char32_t foldCaseAbove2Byte(char32_t cp);
+
+// Simple (one-to-one) lowercase folding; utf8Length(foldCase(cp)) <= utf8Length(cp)
+inline char32_t foldCase(char32_t cp) {
+    return cp < 0x800 ? twoByteFoldTable[cp] : foldCaseAbove2Byte(cp);
+}
+
+// Whitespace outside ASCII: NEL, no-break spaces, the U+2000 spaces, line/paragraph separators
+inline bool isUnicodeSpace(char32_t cp) {
+    if (cp < 0x1680) return cp == 0x85 || cp == 0xA0;
+    return cp == 0x1680 || (cp >= 0x2000 && cp <= 0x200A) || cp == 0x2028 || cp == 0x2029 ||
+           cp == 0x202F || cp == 0x205F || cp == 0x3000;
+}
+
+enum class CharClass : uint8_t { Separator, Word, Ideograph };
+
+CharClass classifyCodePoint(char32_t cp);
+
+#endif // UTF8_H
@@ -0,0 +1,174 @@
+/**
+ * Heap Allocation Accounting for the Benchmarks — implementation
+ * (see alloc_counter.h)
+ */
+
+#include "alloc_counter.h"
+
+#include <iomanip>
+#include <sstream>
+
+#ifdef ALLOC_COUNTING
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#endif
+
+using namespace std;
+
+#ifdef ALLOC_COUNTING
+// ================================================
+//  GLOBAL OPERATOR NEW / DELETE
+// ================================================
+// Every block is [header][user bytes]; the word just before the user bytes holds
+// the size if the block was counted, 0 if not. Aligned blocks use a header of
+// their alignment so the user bytes stay aligned.
+static atomic<bool> counting{false};
+static atomic<uint64_t> allocations{0}, bytesRequested{0};
+static atomic<int64_t> liveBytes{0}, peakLiveBytes{0};
+static int64_t liveAtStart = 0;
+
+static const size_t HEADER_SIZE = alignof(max_align_t);
+
+static void countAllocation(size_t size) {
+    allocations.fetch_add(1, memory_order_relaxed);
+    bytesRequested.fetch_add(size, memory_order_relaxed);
+    int64_t live = liveBytes.fetch_add(size, memory_order_relaxed) + static_cast<int64_t>(size);
+    int64_t peak = peakLiveBytes.load(memory_order_relaxed);
+    while (live > peak && !peakLiveBytes.compare_exchange_weak(peak, live, memory_order_relaxed)) {
+    }
+}
+
+static void* allocateBlock(size_t size, size_t alignment) {
+    size_t header = max(alignment, HEADER_SIZE);
+    void* block;
+    if (alignment <= HEADER_SIZE) {
+        block = malloc(header + size);
+    } else {
+#ifdef _WIN32
+        block = _aligned_malloc(header + size, alignment);
+#else
+        block = aligned_alloc(alignment, (header + size + alignment - 1) / alignment * alignment);
+#endif
+    }
+    if (!block) return nullptr;
+    bool counted = counting.load(memory_order_relaxed);
+    if (counted) countAllocation(size);
+    char* user = static_cast<char*>(block) + header;
+    reinterpret_cast<size_t*>(user)[-1] = counted ? size : 0;
+    return user;
+}
+
+static void* allocateOrThrow(size_t size, size_t alignment) {
+    for (;;) {
+        if (void* user = allocateBlock(size, alignment)) return user;
+        new_handler handler = get_new_handler();
+        if (!handler) throw bad_alloc();
+        handler();
+    }
+}
+
+static void releaseBlock(void* user, size_t alignment) {
+    if (!user) return;
+    size_t size = static_cast<size_t*>(user)[-1];
+    if (size) liveBytes.fetch_sub(size, memory_order_relaxed);
+    void* block = static_cast<char*>(user) - max(alignment, HEADER_SIZE);
+#ifdef _WIN32
+    if (alignment > HEADER_SIZE) {
+        _aligned_free(block);
+        return;
+    }
+#endif
+    free(block);
+}
+
+void* operator new(size_t size) { return allocateOrThrow(size, HEADER_SIZE); }
+void* operator new[](size_t size) { return allocateOrThrow(size, HEADER_SIZE); }
+void* operator new(size_t size, const nothrow_t&) noexcept { return allocateBlock(size, HEADER_SIZE); }
+void* operator new[](size_t size, const nothrow_t&) noexcept { return allocateBlock(size, HEADER_SIZE); }
+void* operator new(size_t size, align_val_t alignment) { return allocateOrThrow(size, size_t(alignment)); }
+void* operator new[](size_t size, align_val_t alignment) { return allocateOrThrow(size, size_t(alignment)); }
+void* operator new(size_t size, align_val_t alignment, const nothrow_t&) noexcept { return allocateBlock(size, size_t(alignment)); }
+void* operator new[](size_t size, align_val_t alignment, const nothrow_t&) noexcept { return allocateBlock(size, size_t(alignment)); }
+
+void operator delete(void* p) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete[](void* p) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete(void* p, size_t) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete[](void* p, size_t) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete(void* p, const nothrow_t&) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete[](void* p, const nothrow_t&) noexcept { releaseBlock(p, HEADER_SIZE); }
+void operator delete(void* p, align_val_t alignment) noexcept { releaseBlock(p, size_t(alignment)); }
+void operator delete[](void* p, align_val_t alignment) noexcept { releaseBlock(p, size_t(alignment)); }
+void operator delete(void* p, size_t, align_val_t alignment) noexcept { releaseBlock(p, size_t(alignment)); }
+void operator delete[](void* p, size_t, align_val_t alignment) noexcept { releaseBlock(p, size_t(alignment)); }
+void operator delete(void* p, align_val_t alignment, const nothrow_t&) noexcept { releaseBlock(p, size_t(alignment)); }
+void operator delete[](void* p, align_val_t alignment, const nothrow_t&) noexcept { releaseBlock(p, size_t(alignment)); }
+
+bool allocCountingAvailable() {
+    return true;
+}
+
+void startAllocCounting() {
+    allocations.store(0, memory_order_relaxed);
+    bytesRequested.store(0, memory_order_relaxed);
+    liveAtStart = liveBytes.load(memory_order_relaxed);
+    peakLiveBytes.store(liveAtStart, memory_order_relaxed);
+    counting.store(true, memory_order_relaxed);
+}
+
+AllocStats stopAllocCounting() {
+    counting.store(false, memory_order_relaxed);
+    AllocStats stats;
+    stats.allocations = allocations.load(memory_order_relaxed);
+    stats.bytes = bytesRequested.load(memory_order_relaxed);
+    stats.peakLiveBytes = max<int64_t>(0, peakLiveBytes.load(memory_order_relaxed) - liveAtStart);
+    return stats;
+}
+#else
+bool allocCountingAvailable() {
+    return false;
+}
+
+void startAllocCounting() {}
+
+AllocStats stopAllocCounting() {
+    return {};
+}
+#endif
+
+// ================================================
+//  REPORTING
+// ================================================
+// 1234567 -> "1.23M"
+static string shortCount(double value) {
+    static const char* const suffixes[] = {"", "K", "M", "G", "T"};
+    int s = 0;
+    while (value >= 1000 && s < 4) {
+        value /= 1000;
+        s++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(s == 0 ? 0 : 2) << value << suffixes[s];
+    return out.str();
+}
+
+// 1234567 -> "1.18 MB"
+static string shortBytes(double value) {
+    static const char* const units[] = {"B", "KB", "MB", "GB"};
+    int u = 0;
+    while (value >= 1024 && u < 3) {
+        value /= 1024;
+        u++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(u == 0 ? 0 : 2) << value << " " << units[u];
+    return out.str();
+}
+
+string describeAllocStats(const AllocStats& stats, double runs) {
+    if (!allocCountingAvailable()) return "(allocation counting not built in: configure with -DP6_ALLOC_COUNTING=ON)";
+    return "allocs " + shortCount(stats.allocations / runs) + "  bytes " + shortBytes(stats.bytes / runs) +
+           "  peak live " + shortBytes(static_cast<double>(stats.peakLiveBytes));
+}
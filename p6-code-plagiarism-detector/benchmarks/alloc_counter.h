@@ -0,0 +1,46 @@
+/**
+ * Heap Allocation Accounting for the Benchmarks
+ * =============================================
+ *
+ * Counts what a stage asks of the heap: allocations, bytes requested and the
+ * peak of live bytes above what was live when the stage began. It works by
+ * replacing the global operator new and delete, so it sees std::string,
+ * std::regex, stringstream and container nodes alike.
+ *
+ * The replacement is opt-in at build time: it exists only when ALLOC_COUNTING
+ * is defined (CMake: -DP6_ALLOC_COUNTING=ON). Otherwise the program keeps the
+ * standard allocator, timings are unaffected and allocCountingAvailable() is
+ * false. With the hook built in, each block carries a small header with its
+ * size, and counting costs nothing beyond one relaxed atomic load until
+ * startAllocCounting().
+ *
+ * Only blocks allocated while counting are tracked, so frees of memory from
+ * before the stage never make its live bytes negative.
+ */
+
+#ifndef ALLOC_COUNTER_H
+#define ALLOC_COUNTER_H
+
+#include <cstdint>
+#include <string>
+
+struct AllocStats {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;          // requested, summed over every allocation
+    uint64_t peakLiveBytes = 0;  // highest live total above the level at start
+};
+
+// True when built with ALLOC_COUNTING
+bool allocCountingAvailable();
+
+// Zero the counters and start counting on every thread
+void startAllocCounting();
+
+// Stop counting and return what was counted since startAllocCounting()
+AllocStats stopAllocCounting();
+
+// "allocs 1.23K  bytes 4.56 MB  peak live 789.0 KB" with the counts and bytes
+// divided by `runs` (the peak is not: it is already per run)
+std::string describeAllocStats(const AllocStats& stats, double runs = 1);
+
+#endif // ALLOC_COUNTER_H
@@ -0,0 +1,314 @@
+/**
+ * Benchmark Regression Comparator
+ * ===============================
+ * Diffs two result files written with --json (see bench_report.h) and flags
+ * every metric that got significantly worse in the candidate:
+ *
+ *   - the change of the median must exceed --threshold percent in the metric's
+ *     "worse" direction, and
+ *   - a one-sided Mann-Whitney U test must reject "no slowdown" at level
+ *     --alpha after the Holm-Bonferroni correction over every tested metric,
+ *     so a run of many metrics does not fail by chance on one of them. Up to
+ *     EXACT_MAX_SAMPLES samples in total the p-value comes from the exact
+ *     distribution of U given the ties, above that from the normal
+ *     approximation. The p column shows the Holm-adjusted value.
+ *
+ * The test needs enough samples to reach --alpha at all: with n runs per side
+ * the smallest possible p is 1 / C(2n, n), and Holm multiplies the smallest p
+ * by the number m of timing metrics. So alpha = 0.01 needs 1 / C(2n, n) <
+ * 0.01 / m: 5 runs for one metric, 7 for 18. A timing metric with too few
+ * samples on either side is reported but never gates (rerun with a larger
+ * --reps); metrics that do not vary between runs (counts, bytes, accuracy)
+ * are judged by the threshold alone.
+ *
+ * Exits with 1 if any metric regressed, so it can gate an upgrade:
+ *   ./stage_bench --json base.json        (old build)
+ *   ./stage_bench --json new.json         (new build, same machine)
+ *   ./bench_compare base.json new.json || echo "regression"
+ *
+ * Build:  cmake --build build --target bench_compare
+ * Run:    ./bench_compare BASELINE.json CANDIDATE.json [--threshold PCT] [--alpha P]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <iomanip>
+#include <cmath>
+#include <map>
+#include <sstream>
+#include <charconv>
+#include <cstring>
+#include "bench_report.h"
+
+using namespace std;
+
+const size_t EXACT_MAX_SAMPLES = 60;
+
+// Units of metrics that vary from run to run (times, rates, speedups)
+const char* const TIMING_UNITS[] = {"ns", "us", "ms", "s", "ns/pair", "docs/s", "x"};
+
+bool isTimingUnit(const string& unit) {
+    for (const char* u : TIMING_UNITS)
+        if (unit == u) return true;
+    return false;
+}
+
+// Smallest one-sided p-value a rank test can reach with these sample sizes: 1 / C(n1 + n2, n1)
+double smallestPValue(size_t n1, size_t n2) {
+    double combinations = 1;
+    for (size_t i = 1; i <= n1; i++) combinations = combinations * (n2 + i) / i;
+    return 1 / combinations;
+}
+
+// ================================================
+//  MANN-WHITNEY U TEST
+// ================================================
+// Exact one-sided p-value: the share of all C(n, n2) ways to label n2 of the pooled
+// (mid-)ranks "candidate" whose rank sum is at least the observed one. Ranks are
+// doubled so mid-ranks stay integers; ways[k][s] counts k-subsets with sum s
+double exactRankSumGreater(const vector<pair<double, int>>& pooled, const vector<int>& doubledRanks, size_t n2) {
+    int observed = 0, total = 0;
+    for (size_t i = 0; i < pooled.size(); i++) {
+        total += doubledRanks[i];
+        if (pooled[i].second == 1) observed += doubledRanks[i];
+    }
+    vector<vector<double>> ways(n2 + 1, vector<double>(total + 1, 0));
+    ways[0][0] = 1;
+    for (int rank : doubledRanks)
+        for (size_t k = n2; k >= 1; k--)
+            for (int s = total; s >= rank; s--) ways[k][s] += ways[k - 1][s - rank];
+
+    double atLeast = 0, all = 0;
+    for (int s = 0; s <= total; s++) {
+        all += ways[n2][s];
+        if (s >= observed) atLeast += ways[n2][s];
+    }
+    return atLeast / all;
+}
+
+// P(candidate is not larger than baseline) under H0, i.e. the one-sided p-value
+// for "candidate > baseline": exact for small samples, otherwise from the normal
+// approximation of U with the tie correction and a continuity correction
+double mannWhitneyGreater(const vector<double>& baseline, const vector<double>& candidate) {
+    double n1 = baseline.size(), n2 = candidate.size();
+    vector<pair<double, int>> pooled;
+    for (double v : baseline) pooled.push_back({v, 0});
+    for (double v : candidate) pooled.push_back({v, 1});
+    sort(pooled.begin(), pooled.end());
+
+    // Mid-ranks for ties, and the sum of t^3 - t over tie groups
+    double candidateRankSum = 0, tieTerm = 0;
+    vector<int> doubledRanks(pooled.size());
+    for (size_t i = 0; i < pooled.size();) {
+        size_t j = i;
+        while (j < pooled.size() && pooled[j].first == pooled[i].first) j++;
+        double rank = (i + 1 + j) / 2.0;
+        double t = j - i;
+        tieTerm += t * t * t - t;
+        for (size_t m = i; m < j; m++) {
+            doubledRanks[m] = static_cast<int>(i + 1 + j);
+            if (pooled[m].second == 1) candidateRankSum += rank;
+        }
+        i = j;
+    }
+    if (pooled.size() <= EXACT_MAX_SAMPLES) return exactRankSumGreater(pooled, doubledRanks, candidate.size());
+
+    double u = candidateRankSum - n2 * (n2 + 1) / 2;
+    double n = n1 + n2;
+    double mean = n1 * n2 / 2;
+    double variance = n1 * n2 / 12 * ((n + 1) - tieTerm / (n * (n - 1)));
+    if (variance <= 0) return 1.0; // every sample identical
+    double z = (u - mean - 0.5) / sqrt(variance);
+    return 0.5 * erfc(z / sqrt(2.0));
+}
+
+// ================================================
+//  COMPARISON
+// ================================================
+struct Verdict {
+    double changePercent = 0;              // positive: worse
+    double pWorse = NAN, pBetter = NAN;    // raw one-sided p-values; NaN: not tested
+    double pValue = NAN;                   // Holm-adjusted p in the direction of the change
+    bool regressed = false, improved = false;
+    bool gated = true;                     // false: a timing metric with too few samples, reported only
+};
+
+// Change of the median and, for a timing metric with enough samples to reach
+// alpha / familySize, the raw p-values of both one-sided tests
+Verdict compareMetric(const Metric& baseline, const Metric& candidate, size_t familySize, double alpha) {
+    Verdict verdict;
+    double change = baseline.median != 0 ? (candidate.median - baseline.median) / fabs(baseline.median) * 100 : 0;
+    verdict.changePercent = baseline.lowerIsBetter ? change : -change;
+
+    bool timing = isTimingUnit(candidate.unit);
+    bool tested = timing && smallestPValue(baseline.samples.size(), candidate.samples.size()) * familySize < alpha;
+    verdict.gated = tested || !timing;
+    if (tested) {
+        // Test in the metric's "worse" direction, and the opposite one for improvements
+        verdict.pWorse = baseline.lowerIsBetter ? mannWhitneyGreater(baseline.samples, candidate.samples)
+                                                : mannWhitneyGreater(candidate.samples, baseline.samples);
+        verdict.pBetter = baseline.lowerIsBetter ? mannWhitneyGreater(candidate.samples, baseline.samples)
+                                                 : mannWhitneyGreater(baseline.samples, candidate.samples);
+    }
+    return verdict;
+}
+
+// Holm-Bonferroni step-down adjustment; NaN entries (untested) are left out and stay NaN
+vector<double> holmAdjust(const vector<double>& pValues) {
+    vector<size_t> order;
+    for (size_t i = 0; i < pValues.size(); i++)
+        if (!isnan(pValues[i])) order.push_back(i);
+    sort(order.begin(), order.end(), [&](size_t a, size_t b) { return pValues[a] < pValues[b]; });
+
+    vector<double> adjusted(pValues.size(), NAN);
+    double running = 0;
+    for (size_t rank = 0; rank < order.size(); rank++) {
+        running = max(running, min(1.0, (order.size() - rank) * pValues[order[rank]]));
+        adjusted[order[rank]] = running;
+    }
+    return adjusted;
+}
+
+// Regressed / improved once the p-values are adjusted; untested metrics go by the threshold
+void decide(Verdict& verdict, double pWorse, double pBetter, double thresholdPercent, double alpha) {
+    bool tested = !isnan(pWorse);
+    bool worseSignificant = tested ? pWorse < alpha : verdict.gated;
+    bool betterSignificant = tested ? pBetter < alpha : verdict.gated;
+    if (tested) verdict.pValue = verdict.changePercent >= 0 ? pWorse : pBetter;
+    verdict.regressed = verdict.changePercent > thresholdPercent && worseSignificant;
+    verdict.improved = -verdict.changePercent > thresholdPercent && betterSignificant;
+}
+
+// A whole finite number: atof would turn a typo into 0
+bool parseNumber(const char* text, double& value) {
+    const char* end = text + strlen(text);
+    double parsed = 0;
+    auto [ptr, error] = from_chars(text, end, parsed);
+    if (error != errc() || ptr != end || ptr == text || !isfinite(parsed)) return false;
+    value = parsed;
+    return true;
+}
+
+bool sameMachine(const MachineInfo& a, const MachineInfo& b, vector<string>& differences) {
+    if (a.host != b.host) differences.push_back("host: " + a.host + " vs " + b.host);
+    if (a.cpu != b.cpu) differences.push_back("cpu: " + a.cpu + " vs " + b.cpu);
+    if (a.logicalCpus != b.logicalCpus)
+        differences.push_back("logical cpus: " + to_string(a.logicalCpus) + " vs " + to_string(b.logicalCpus));
+    if (a.os != b.os) differences.push_back("os: " + a.os + " vs " + b.os);
+    if (a.compiler != b.compiler) differences.push_back("compiler: " + a.compiler + " vs " + b.compiler);
+    if (a.build != b.build) differences.push_back("build: " + a.build + " vs " + b.build);
+    return differences.empty();
+}
+
+// ================================================
+//  MAIN
+// ================================================
+int main(int argc, char* argv[]) {
+    vector<string> paths;
+    double thresholdPercent = 5, alpha = 0.01;
+    bool valid = true;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--threshold" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], thresholdPercent) && valid;
+        } else if (arg == "--alpha" && i + 1 < argc) {
+            valid = parseNumber(argv[++i], alpha) && valid;
+        } else if (arg.rfind("--", 0) == 0) {
+            valid = false;
+        } else {
+            paths.push_back(arg);
+        }
+    }
+    if (!valid || paths.size() != 2 || thresholdPercent < 0 || alpha <= 0 || alpha >= 1) {
+        cerr << "Usage: " << argv[0] << " BASELINE.json CANDIDATE.json [--threshold PCT] [--alpha P]\n";
+        return 2;
+    }
+
+    BenchReport baseline, candidate;
+    if (!baseline.load(paths[0])) {
+        cerr << "Error: " << paths[0] << " is not a benchmark result\n";
+        return 2;
+    }
+    if (!candidate.load(paths[1])) {
+        cerr << "Error: " << paths[1] << " is not a benchmark result\n";
+        return 2;
+    }
+
+    cout << "Baseline : " << paths[0] << " (" << baseline.benchmark << ", " << baseline.machine.timestamp << ")\n";
+    cout << "Candidate: " << paths[1] << " (" << candidate.benchmark << ", " << candidate.machine.timestamp << ")\n";
+    if (baseline.benchmark != candidate.benchmark)
+        cout << "Warning: the files come from different benchmarks\n";
+    vector<string> differences;
+    if (!sameMachine(baseline.machine, candidate.machine, differences)) {
+        cout << "Warning: measured on different machines or builds, timings may not be comparable\n";
+        for (auto& d : differences) cout << "  " << d << "\n";
+    }
+    map<string, const Metric*> baselineByName;
+    for (auto& m : baseline.metrics) baselineByName[m.name] = &m;
+
+    // The Holm family: every timing metric present in both files
+    size_t familySize = 0;
+    for (auto& c : candidate.metrics)
+        if (baselineByName.count(c.name) && isTimingUnit(c.unit)) familySize++;
+    familySize = max<size_t>(familySize, 1);
+    size_t minRuns = 1;
+    while (smallestPValue(minRuns, minRuns) * familySize >= alpha) minRuns++;
+    cout << "Regression: median worse by > " << thresholdPercent << "% and one-sided Mann-Whitney p < " << alpha
+         << ", Holm-adjusted over " << familySize << " timing metric(s)"
+         << "\n(timing metrics need " << minRuns << "+ samples per side to be tested; with fewer they are not gated)\n\n";
+
+    size_t nameWidth = 6;
+    for (auto& m : candidate.metrics) nameWidth = max(nameWidth, m.name.size());
+    cout << "  " << left << setw(nameWidth) << "metric" << right << setw(14) << "baseline" << setw(14) << "candidate"
+         << setw(10) << "change" << setw(10) << "p (Holm)" << "  verdict\n";
+
+    // Test every metric first: the adjustment needs all the p-values
+    vector<Verdict> verdicts;
+    vector<double> pWorse, pBetter;
+    for (auto& c : candidate.metrics) {
+        auto found = baselineByName.find(c.name);
+        verdicts.push_back(found == baselineByName.end() ? Verdict() : compareMetric(*found->second, c, familySize, alpha));
+        pWorse.push_back(verdicts.back().pWorse);
+        pBetter.push_back(verdicts.back().pBetter);
+    }
+    vector<double> adjustedWorse = holmAdjust(pWorse), adjustedBetter = holmAdjust(pBetter);
+
+    int regressions = 0, improvements = 0, ungated = 0;
+    for (size_t i = 0; i < candidate.metrics.size(); i++) {
+        const Metric& c = candidate.metrics[i];
+        auto found = baselineByName.find(c.name);
+        if (found == baselineByName.end()) {
+            cout << "  " << left << setw(nameWidth) << c.name << right << setw(14) << "-" << setw(14) << c.median
+                 << " " << c.unit << "  (new metric)\n";
+            continue;
+        }
+        const Metric& b = *found->second;
+        baselineByName.erase(found);
+        Verdict& v = verdicts[i];
+        decide(v, adjustedWorse[i], adjustedBetter[i], thresholdPercent, alpha);
+        // Printed as the raw change of the median; the verdict knows which way is worse
+        double rawChange = b.median != 0 ? (c.median - b.median) / fabs(b.median) * 100 : 0;
+        ostringstream change, p;
+        change << showpos << fixed << setprecision(1) << rawChange << "%";
+        if (isnan(v.pValue)) p << "-";
+        else p << setprecision(2) << v.pValue;
+        cout << "  " << left << setw(nameWidth) << c.name << right << fixed << setprecision(3)
+             << setw(14) << b.median << setw(14) << c.median << setw(10) << change.str() << setw(10) << p.str()
+             << "  " << (v.regressed ? "REGRESSION" : v.improved ? "improved" : !v.gated ? "not gated" : "ok") << " (" << c.unit << ", "
+             << (c.lowerIsBetter ? "lower" : "higher") << " is better)\n";
+        if (v.regressed) regressions++;
+        if (v.improved) improvements++;
+        if (!v.gated) ungated++;
+    }
+    for (auto& [name, metric] : baselineByName)
+        cout << "  " << left << setw(nameWidth) << name << "  (missing from candidate)\n";
+
+    cout << "\n" << regressions << " regression(s), " << improvements << " improvement(s) across "
+         << candidate.metrics.size() << " metric(s)\n";
+    if (ungated > 0)
+        cout << ungated << " timing metric(s) had fewer than " << minRuns << " samples per side and were not gated;"
+             << " rerun with --reps " << minRuns << " or more\n";
+    return regressions > 0 ? 1 : 0;
+}
@@ -0,0 +1,366 @@
+/**
+ * Machine-Readable Benchmark Results — implementation
+ * (see bench_report.h)
+ */
+
+#include "bench_report.h"
+
+#include <algorithm>
+#include <charconv>
+#include <chrono>
+#include <cmath>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <thread>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+// ================================================
+//  MACHINE FINGERPRINT
+// ================================================
+
+static string cpuModel() {
+#if defined(__linux__)
+    ifstream cpuinfo("/proc/cpuinfo");
+    string line;
+    while (getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0) {
+            size_t colon = line.find(':');
+            if (colon != string::npos) return line.substr(line.find_first_not_of(' ', colon + 1));
+        }
+    }
+#endif
+    return "unknown";
+}
+
+MachineInfo currentMachine() {
+    MachineInfo machine;
+#if defined(_WIN32)
+    char name[256];
+    DWORD size = sizeof(name);
+    machine.host = GetComputerNameA(name, &size) ? name : "unknown";
+    machine.os = "Windows";
+#else
+    char name[256] = {};
+    machine.host = gethostname(name, sizeof(name) - 1) == 0 ? name : "unknown";
+    utsname system;
+    machine.os = uname(&system) == 0 ? string(system.sysname) + " " + system.release + " " + system.machine : "unknown";
+#endif
+    machine.cpu = cpuModel();
+    machine.logicalCpus = thread::hardware_concurrency();
+#if defined(__clang__)
+    machine.compiler = "clang " __clang_version__;
+#elif defined(__GNUC__)
+    machine.compiler = "gcc " __VERSION__;
+#elif defined(_MSC_VER)
+    machine.compiler = "msvc " + to_string(_MSC_VER);
+#else
+    machine.compiler = "unknown";
+#endif
+#ifdef NDEBUG
+    machine.build = "release";
+#else
+    machine.build = "debug";
+#endif
+#if defined(__OPTIMIZE__)
+    machine.build += " optimized";
+#endif
+
+    time_t now = chrono::system_clock::to_time_t(chrono::system_clock::now());
+    char stamp[32];
+    strftime(stamp, sizeof(stamp), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+    machine.timestamp = stamp;
+    return machine;
+}
+
+// ================================================
+//  METRICS
+// ================================================
+
+Metric makeMetric(const string& name, const string& unit, vector<double> samples, bool lowerIsBetter) {
+    Metric metric;
+    metric.name = name;
+    metric.unit = unit;
+    metric.lowerIsBetter = lowerIsBetter;
+    metric.count = samples.size();
+    if (samples.empty()) return metric;
+
+    sort(samples.begin(), samples.end());
+    double sum = 0;
+    for (double s : samples) sum += s;
+    metric.mean = sum / samples.size();
+    size_t n = samples.size();
+    metric.median = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    double squares = 0;
+    for (double s : samples) squares += (s - metric.mean) * (s - metric.mean);
+    metric.stddev = n > 1 ? sqrt(squares / (n - 1)) : 0;
+    metric.min = samples.front();
+    metric.max = samples.back();
+
+    if (n <= MAX_KEPT_SAMPLES) {
+        metric.samples = move(samples);
+    } else {
+        for (size_t i = 0; i < MAX_KEPT_SAMPLES; ++i) {
+            metric.samples.push_back(samples[i * (n - 1) / (MAX_KEPT_SAMPLES - 1)]);
+        }
+    }
+    return metric;
+}
+
+BenchReport::BenchReport(string benchmark) : benchmark(move(benchmark)), machine(currentMachine()) {}
+
+// ================================================
+//  JSON OUTPUT
+// ================================================
+
+static string jsonString(const string& s) {
+    static const char hexDigits[] = "0123456789abcdef";
+    string quoted = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c < 0x20) {
+            quoted += "\\u00";
+            quoted += hexDigits[c >> 4];
+            quoted += hexDigits[c & 0xF];
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+static string jsonNumber(double value) {
+    if (!isfinite(value)) return "null";
+    char buffer[32];
+    auto result = to_chars(buffer, buffer + sizeof(buffer), value);
+    return string(buffer, result.ptr);
+}
+
+bool BenchReport::save(const string& path) const {
+    ofstream out(path);
+    if (!out) return false;
+    out << "{\n  \"benchmark\": " << jsonString(benchmark) << ",\n  \"schema\": 1,\n";
+    out << "  \"machine\": {\"host\": " << jsonString(machine.host) << ", \"os\": " << jsonString(machine.os)
+        << ", \"cpu\": " << jsonString(machine.cpu) << ", \"logical_cpus\": " << machine.logicalCpus
+        << ", \"compiler\": " << jsonString(machine.compiler) << ", \"build\": " << jsonString(machine.build)
+        << ", \"timestamp\": " << jsonString(machine.timestamp) << "},\n";
+    out << "  \"metrics\": [";
+    for (size_t m = 0; m < metrics.size(); ++m) {
+        const Metric& metric = metrics[m];
+        out << (m ? ",\n" : "\n") << "    {\"name\": " << jsonString(metric.name) << ", \"unit\": " << jsonString(metric.unit)
+            << ", \"better\": \"" << (metric.lowerIsBetter ? "lower" : "higher") << "\", \"count\": " << metric.count
+            << ", \"mean\": " << jsonNumber(metric.mean) << ", \"median\": " << jsonNumber(metric.median)
+            << ", \"stddev\": " << jsonNumber(metric.stddev) << ", \"min\": " << jsonNumber(metric.min)
+            << ", \"max\": " << jsonNumber(metric.max) << ", \"samples\": [";
+        for (size_t i = 0; i < metric.samples.size(); ++i) {
+            out << (i ? ", " : "") << jsonNumber(metric.samples[i]);
+        }
+        out << "]}";
+    }
+    out << "\n  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+// ================================================
+//  JSON INPUT  (just enough of JSON for the files above)
+// ================================================
+
+struct JsonValue {
+    enum class Type { Null, Bool, Number, String, Array, Object } type = Type::Null;
+    double number = 0;
+    string text;
+    vector<JsonValue> items;
+    vector<pair<string, JsonValue>> fields;
+
+    const JsonValue* field(const string& name) const {
+        for (const auto& [key, value] : fields) {
+            if (key == name) return &value;
+        }
+        return nullptr;
+    }
+};
+
+class JsonParser {
+public:
+    explicit JsonParser(const string& text) : text(text) {}
+
+    bool parse(JsonValue& value) {
+        if (!parseValue(value)) return false;
+        skipSpace();
+        return pos == text.size();
+    }
+
+private:
+    const string& text;
+    size_t pos = 0;
+
+    void skipSpace() {
+        while (pos < text.size() && isspace(static_cast<unsigned char>(text[pos]))) ++pos;
+    }
+
+    bool literal(const char* word) {
+        size_t length = char_traits<char>::length(word);
+        if (text.compare(pos, length, word) != 0) return false;
+        pos += length;
+        return true;
+    }
+
+    bool parseString(string& out) {
+        if (text[pos] != '"') return false;
+        ++pos;
+        while (pos < text.size() && text[pos] != '"') {
+            char c = text[pos++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) return false;
+            char escape = text[pos++];
+            switch (escape) {
+            case 'n': out += '\n'; break;
+            case 't': out += '\t'; break;
+            case 'r': out += '\r'; break;
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'u': {
+                if (pos + 4 > text.size()) return false;
+                unsigned code = 0;
+                from_chars(text.data() + pos, text.data() + pos + 4, code, 16);
+                pos += 4;
+                out += code < 0x80 ? static_cast<char>(code) : '?'; // the writer only escapes control characters
+                break;
+            }
+            default: out += escape; break;
+            }
+        }
+        if (pos >= text.size()) return false;
+        ++pos;
+        return true;
+    }
+
+    bool parseValue(JsonValue& value) {
+        skipSpace();
+        if (pos >= text.size()) return false;
+        char c = text[pos];
+        if (c == '{') {
+            value.type = JsonValue::Type::Object;
+            ++pos;
+            skipSpace();
+            if (pos < text.size() && text[pos] == '}') return ++pos, true;
+            while (true) {
+                skipSpace();
+                string key;
+                if (pos >= text.size() || !parseString(key)) return false;
+                skipSpace();
+                if (pos >= text.size() || text[pos++] != ':') return false;
+                JsonValue item;
+                if (!parseValue(item)) return false;
+                value.fields.emplace_back(move(key), move(item));
+                skipSpace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') { ++pos; continue; }
+                if (text[pos] == '}') return ++pos, true;
+                return false;
+            }
+        }
+        if (c == '[') {
+            value.type = JsonValue::Type::Array;
+            ++pos;
+            skipSpace();
+            if (pos < text.size() && text[pos] == ']') return ++pos, true;
+            while (true) {
+                JsonValue item;
+                if (!parseValue(item)) return false;
+                value.items.push_back(move(item));
+                skipSpace();
+                if (pos >= text.size()) return false;
+                if (text[pos] == ',') { ++pos; continue; }
+                if (text[pos] == ']') return ++pos, true;
+                return false;
+            }
+        }
+        if (c == '"') {
+            value.type = JsonValue::Type::String;
+            return parseString(value.text);
+        }
+        if (literal("true")) { value.type = JsonValue::Type::Bool; value.number = 1; return true; }
+        if (literal("false")) { value.type = JsonValue::Type::Bool; return true; }
+        if (literal("null")) { value.type = JsonValue::Type::Null; return true; }
+
+        value.type = JsonValue::Type::Number;
+        const char* begin = text.data() + pos;
+        auto result = from_chars(begin, text.data() + text.size(), value.number);
+        if (result.ec != errc()) return false;
+        pos += result.ptr - begin;
+        return true;
+    }
+};
+
+static string textField(const JsonValue& object, const string& name) {
+    const JsonValue* value = object.field(name);
+    return value && value->type == JsonValue::Type::String ? value->text : "";
+}
+
+static double numberField(const JsonValue& object, const string& name) {
+    const JsonValue* value = object.field(name);
+    return value && value->type == JsonValue::Type::Number ? value->number : NAN;
+}
+
+bool BenchReport::load(const string& path) {
+    ifstream in(path);
+    if (!in) return false;
+    stringstream buffer;
+    buffer << in.rdbuf();
+    string text = buffer.str();
+
+    JsonValue root;
+    if (!JsonParser(text).parse(root) || root.type != JsonValue::Type::Object) return false;
+    const JsonValue* metricList = root.field("metrics");
+    if (!metricList || metricList->type != JsonValue::Type::Array) return false;
+
+    benchmark = textField(root, "benchmark");
+    machine = MachineInfo();
+    if (const JsonValue* m = root.field("machine")) {
+        machine.host = textField(*m, "host");
+        machine.os = textField(*m, "os");
+        machine.cpu = textField(*m, "cpu");
+        machine.compiler = textField(*m, "compiler");
+        machine.build = textField(*m, "build");
+        machine.timestamp = textField(*m, "timestamp");
+        double cpus = numberField(*m, "logical_cpus");
+        machine.logicalCpus = isnan(cpus) ? 0 : static_cast<unsigned>(cpus);
+    }
+
+    metrics.clear();
+    for (const JsonValue& item : metricList->items) {
+        Metric metric;
+        metric.name = textField(item, "name");
+        metric.unit = textField(item, "unit");
+        metric.lowerIsBetter = textField(item, "better") != "higher";
+        double count = numberField(item, "count");
+        metric.count = isnan(count) ? 0 : static_cast<size_t>(count);
+        metric.mean = numberField(item, "mean");
+        metric.median = numberField(item, "median");
+        metric.stddev = numberField(item, "stddev");
+        metric.min = numberField(item, "min");
+        metric.max = numberField(item, "max");
+        if (const JsonValue* samples = item.field("samples")) {
+            for (const JsonValue& s : samples->items) {
+                if (s.type == JsonValue::Type::Number) metric.samples.push_back(s.number);
+            }
+        }
+        if (metric.name.empty()) return false;
+        metrics.push_back(move(metric));
+    }
+    return true;
+}
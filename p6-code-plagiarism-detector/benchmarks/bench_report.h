@@ -0,0 +1,74 @@
+/**
+ * Machine-Readable Benchmark Results
+ * ==================================
+ *
+ * Every benchmark can write its measurements as one JSON document (--json FILE),
+ * which bench_compare diffs against a baseline:
+ *
+ *   {
+ *     "benchmark": "stage_bench",
+ *     "schema": 1,
+ *     "machine": { "host": .., "os": .., "cpu": .., "logical_cpus": ..,
+ *                  "compiler": .., "build": .., "timestamp": .. },
+ *     "metrics": [
+ *       { "name": "tokenize/1000", "unit": "us", "better": "lower",
+ *         "count": 28, "mean": .., "median": .., "stddev": .., "min": .., "max": ..,
+ *         "samples": [ .. ] },
+ *       ...
+ *     ]
+ *   }
+ *
+ * "samples" keeps every measurement when there are at most MAX_KEPT_SAMPLES,
+ * otherwise that many evenly spaced quantiles of them; the statistics are
+ * always over every measurement. A metric measured once has count 1.
+ */
+
+#ifndef BENCH_REPORT_H
+#define BENCH_REPORT_H
+
+#include <string>
+#include <vector>
+
+const size_t MAX_KEPT_SAMPLES = 256;
+
+struct MachineInfo {
+    std::string host, os, cpu, compiler, build, timestamp;
+    unsigned logicalCpus = 0;
+};
+
+// The machine this process runs on
+MachineInfo currentMachine();
+
+struct Metric {
+    std::string name;
+    std::string unit;
+    bool lowerIsBetter = true;
+    size_t count = 0;
+    double mean = 0, median = 0, stddev = 0, min = 0, max = 0;
+    std::vector<double> samples;
+};
+
+// Statistics over `samples`, keeping at most MAX_KEPT_SAMPLES of them
+Metric makeMetric(const std::string& name, const std::string& unit, std::vector<double> samples,
+                  bool lowerIsBetter = true);
+
+struct BenchReport {
+    std::string benchmark;
+    MachineInfo machine;
+    std::vector<Metric> metrics;
+
+    explicit BenchReport(std::string benchmark = "");
+
+    void add(const std::string& name, const std::string& unit, std::vector<double> samples, bool lowerIsBetter = true) {
+        metrics.push_back(makeMetric(name, unit, std::move(samples), lowerIsBetter));
+    }
+    void add(const std::string& name, const std::string& unit, double value, bool lowerIsBetter = true) {
+        add(name, unit, std::vector<double>{value}, lowerIsBetter);
+    }
+
+    bool save(const std::string& path) const;
+    // False if the file is missing or is not a benchmark result
+    bool load(const std::string& path);
+};
+
+#endif // BENCH_REPORT_H
@@ -4,8 +4,15 @@
  * Measures: corpus scale, wall-clock time, peak memory,
  *           k-gram stats, brute-force vs. hashing speedup, accuracy.
  *
- * Compile: g++ -O2 -std=c++20 -o benchmark benchmark.cpp
- * Run:     ./benchmark   (from the p6 directory so test*.cpp are found)
+ * Compile: g++ -O2 -std=c++20 -I.. -I../../common -o benchmark benchmark.cpp resource_usage.cpp bench_report.cpp perf_counters.cpp alloc_counter.cpp jaccard_oracle.cpp ../pipeline.cpp ../../common/trace.cpp ../../common/timeline.cpp
+ *          (or build the `benchmark` target with CMake)
+ * Run:     ./benchmark [--reps N] [--json FILE] [--perf] [--alloc]   (from the p6 directory so test*.cpp are found)
+ *
+ * --reps repeats every timing N times and reports the median (default 1);
+ * --json writes the numbers as metrics for bench_compare (see bench_report.h);
+ * --perf adds hardware counters to each stage in [3] (see perf_counters.h);
+ * --alloc adds heap allocations, bytes and peak live bytes to each stage in [3]
+ * (see alloc_counter.h; needs a build configured with -DP6_ALLOC_COUNTING=ON).
  */
 
 #include <iostream>
@@ -14,171 +21,68 @@
 #include <string>
 #include <vector>
 #include <unordered_set>
-#include <unordered_map>
-#include <regex>
 #include <algorithm>
 #include <iomanip>
 #include <chrono>
 #include <cmath>
 #include <numeric>
-#include <set>
 #include <filesystem>
-
-#ifdef _WIN32
-#include <windows.h>
-#include <psapi.h>
-#pragma comment(lib, "psapi.lib")
-#endif
+#include <memory>
+#include "resource_usage.h"
+#include "bench_report.h"
+#include "perf_counters.h"
+#include "alloc_counter.h"
+#include "jaccard_oracle.h"   // brute-force baseline: exact k-gram STRING Jaccard
+#include "pipeline.h"   // the production stages, not a copy
 
 using namespace std;
 namespace fs = std::filesystem;
 
 // ================================================
-//  UTILITIES — memory measurement
-// ================================================
-size_t getPeakMemoryKB() {
-#ifdef _WIN32
-    PROCESS_MEMORY_COUNTERS pmc;
-    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
-        return pmc.PeakWorkingSetSize / 1024;
-#endif
-    return 0;
-}
-
-// ================================================
-//  PIPELINE FUNCTIONS (copied from project6.cpp)
+//  UTILITIES — per-stage resource measurement
 // ================================================
-
-string readFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) { cerr << "Error opening file: " << filename << endl; return ""; }
-    stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
-    return buffer.str();
-}
-
-string normalizeSpacesAndLines(const string& code) {
-    stringstream ss(code);
-    string line, result;
-    while (getline(ss, line)) {
-        line = regex_replace(line, regex("^\\s+|\\s+$"), "");
-        line = regex_replace(line, regex("[ \\t]+"), " ");
-        if (!line.empty()) result += line + "\n";
-    }
-    return result;
-}
-
-string removeComments(const string& code) {
-    regex multiLineComments(R"(/\*[\s\S]*?\*/)");
-    string withoutMultiLine = regex_replace(code, multiLineComments, "");
-    regex singleLineComments(R"(//[^\n]*)");
-    return regex_replace(withoutMultiLine, singleLineComments, "");
-}
-
-// Per-run variable map — we reset between benchmark iterations
-unordered_map<string, string> variableMap;
-int varCounter = 1;
-
-void resetVariableMap() {
-    variableMap.clear();
-    varCounter = 1;
-}
-
-string normalizeVariables(string code) {
-    unordered_set<string> skipNames = {"main","cout","cin","endl","vector","string",
-                                       "bool","char","int","float","double","return","for","if","while"};
-    regex declLinePattern(R"(\b(int|float|double|char|string|bool|vector|auto|size_t)\b\s+([^;=\)]+)[;=\)])");
-    smatch match;
-    string::const_iterator searchStart(code.cbegin());
-    while (regex_search(searchStart, code.cend(), match, declLinePattern)) {
-        string varList = match[2];
-        stringstream ss(varList);
-        string token;
-        while (getline(ss, token, ',')) {
-            token = regex_replace(token, regex(R"(\[.*\])"), "");
-            token = regex_replace(token, regex(R"(^\s+|\s+$)"), "");
-            smatch varMatch;
-            regex varNamePattern(R"(([a-zA-Z_][a-zA-Z0-9_]*))");
-            if (regex_search(token, varMatch, varNamePattern)) {
-                string varName = varMatch[1];
-                if (!varName.empty() && skipNames.find(varName) == skipNames.end()
-                    && variableMap.find(varName) == variableMap.end()) {
-                    variableMap[varName] = "var" + to_string(varCounter++);
-                }
-            }
-        }
-        searchStart = match.suffix().first;
-    }
-    for (const auto& [original, normalized] : variableMap)
-        code = regex_replace(code, regex("\\b" + original + "\\b"), normalized);
-    return code;
+// Set by --perf when at least one hardware counter may be opened
+unique_ptr<PerfCounters> stageCounters;
+vector<PerfSample> stageCounts;   // one per measureStage() call while counting
+// Set by --alloc when the allocation hook is built in
+bool countStageAllocs = false;
+vector<AllocStats> stageAllocs;   // one per measureStage() call while counting
+
+// Time one stage and sample RSS and page faults on either side of it;
+// the peak is restarted first so it belongs to this stage
+template <typename Stage>
+StageUsage measureStage(const string& name, Stage&& stage) {
+    StageUsage usage;
+    usage.stage = name;
+    resetPeakRss();
+    usage.before = sampleResources();
+    if (stageCounters) stageCounters->start();
+    if (countStageAllocs) startAllocCounting();
+    auto start = chrono::high_resolution_clock::now();
+    stage();
+    usage.ms = chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count();
+    if (countStageAllocs) stageAllocs.push_back(stopAllocCounting());
+    if (stageCounters) stageCounts.push_back(stageCounters->stop());
+    usage.after = sampleResources();
+    return usage;
 }
 
-vector<string> tokenize(const string& code) {
-    vector<string> tokens;
-    regex pattern(R"((\".*?\")|([a-zA-Z_][a-zA-Z0-9_]*)|(\d+(\.\d+)?)|(\+\+|--|==|!=|<=|>=)|([=+\-*/%<>&|^!;:.,()[\]{}]))");
-    smatch match;
-    string input = code;
-    while (regex_search(input, match, pattern)) {
-        tokens.push_back(match.str(0));
-        input = match.suffix().str();
+// Wall time of `reps` runs of `body`, in ms
+template <typename Body>
+vector<double> timeRuns(int reps, Body&& body) {
+    vector<double> runs;
+    for (int r = 0; r < reps; r++) {
+        auto start = chrono::high_resolution_clock::now();
+        body();
+        runs.push_back(chrono::duration<double, milli>(chrono::high_resolution_clock::now() - start).count());
     }
-    return tokens;
+    return runs;
 }
 
-vector<string> createKGrams(const vector<string>& tokens, int k) {
-    vector<string> kgrams;
-    if ((int)tokens.size() < k) return kgrams;
-    for (size_t i = 0; i <= tokens.size() - k; ++i) {
-        stringstream kgram;
-        for (int j = 0; j < k; ++j) {
-            kgram << tokens[i + j];
-            if (j < k - 1) kgram << " ";
-        }
-        kgrams.push_back(kgram.str());
-    }
-    return kgrams;
-}
-
-unsigned long simpleHash(const string& s) {
-    const int base = 257;
-    const int mod = 1000000007;
-    unsigned long hash = 0;
-    for (char c : s) hash = (hash * base + c) % mod;
-    return hash;
-}
-
-unordered_set<unsigned long> hashKGrams(const vector<string>& kgrams) {
-    unordered_set<unsigned long> hashSet;
-    for (const string& kgram : kgrams)
-        hashSet.insert(simpleHash(kgram));
-    return hashSet;
-}
-
-double computeJaccard(const unordered_set<unsigned long>& A, const unordered_set<unsigned long>& B) {
-    if (A.empty() && B.empty()) return 1.0;
-    int intersectionSize = 0;
-    for (const auto& h : A)
-        if (B.count(h)) intersectionSize++;
-    int unionSize = (int)A.size() + (int)B.size() - intersectionSize;
-    return (double)intersectionSize / unionSize;
-}
-
-// ================================================
-//  BRUTE-FORCE BASELINE  (O(n²) string comparison)
-// ================================================
-// Compare two normalized code strings using exact k-gram STRING matching
-// (no hashing — store actual strings in sets and compute Jaccard on strings).
-double bruteForceJaccard(const vector<string>& kgramsA, const vector<string>& kgramsB) {
-    set<string> setA(kgramsA.begin(), kgramsA.end());
-    set<string> setB(kgramsB.begin(), kgramsB.end());
-    if (setA.empty() && setB.empty()) return 1.0;
-    int inter = 0;
-    for (const auto& s : setA)
-        if (setB.count(s)) inter++;
-    int uni = (int)setA.size() + (int)setB.size() - inter;
-    return (double)inter / uni;
+double median(vector<double> values) {
+    sort(values.begin(), values.end());
+    size_t n = values.size();
+    return n % 2 ? values[n / 2] : (values[n / 2 - 1] + values[n / 2]) / 2;
 }
 
 // ================================================
@@ -223,7 +127,38 @@ string generateSyntheticCpp(int id, int targetLines) {
 // ================================================
 //  MAIN — benchmark driver
 // ================================================
-int main() {
+int main(int argc, char* argv[]) {
+    int reps = 1;
+    string jsonPath;
+    bool perf = false, alloc = false;
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg == "--reps" && i + 1 < argc) {
+            reps = atoi(argv[++i]);
+        } else if (arg == "--json" && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (arg == "--perf") {
+            perf = true;
+        } else if (arg == "--alloc") {
+            alloc = true;
+        } else {
+            reps = 0;
+            break;
+        }
+    }
+    if (reps <= 0) {
+        cerr << "Usage: " << argv[0] << " [--reps N] [--json FILE] [--perf] [--alloc]\n";
+        return 1;
+    }
+    BenchReport report("benchmark");
+    string counterStatus;
+    if (perf) {
+        stageCounters = make_unique<PerfCounters>();
+        counterStatus = stageCounters->status();
+        if (!stageCounters->available()) stageCounters.reset();
+    }
+    countStageAllocs = alloc && allocCountingAvailable();
+
     cout << "========================================================\n";
     cout << "  C++ Plagiarism Detection — Benchmark Report\n";
     cout << "========================================================\n\n";
@@ -268,70 +203,157 @@ int main() {
     // ------------------------------------------------------------------
     cout << "[2] PERFORMANCE BENCHMARK\n";
 
+    if (reps > 1) cout << "    (median of " << reps << " runs)\n";
+
     // --- 6 real files ---
-    auto t0 = chrono::high_resolution_clock::now();
-    resetVariableMap();
     vector<unordered_set<unsigned long>> hashSets6;
     vector<vector<string>> allKgrams6;     // save for brute-force later
     vector<int> kgramCounts6;
-    for (auto& raw : rawContents) {
-        string clean = normalizeSpacesAndLines(raw);
-        clean = removeComments(clean);
-        clean = normalizeVariables(clean);
-        auto tok = tokenize(clean);
-        auto kg  = createKGrams(tok, k);
-        kgramCounts6.push_back((int)kg.size());
-        allKgrams6.push_back(kg);
-        hashSets6.push_back(hashKGrams(kg));
-    }
-    // pairwise Jaccard
     int pairs6 = 0;
-    for (size_t i = 0; i < hashSets6.size(); i++)
-        for (size_t j = i+1; j < hashSets6.size(); j++) {
-            computeJaccard(hashSets6[i], hashSets6[j]);
-            pairs6++;
+    vector<double> runs6 = timeRuns(reps, [&] {
+        resetVariableMap();
+        hashSets6.clear();
+        allKgrams6.clear();
+        kgramCounts6.clear();
+        for (auto& raw : rawContents) {
+            string clean = normalizeSpacesAndLines(raw);
+            clean = removeComments(clean);
+            clean = normalizeVariables(clean);
+            auto tok = tokenize(clean);
+            auto kg  = createKGrams(tok, k);
+            kgramCounts6.push_back((int)kg.size());
+            allKgrams6.push_back(kg);
+            hashSets6.push_back(hashKGrams(kg));
         }
-    auto t1 = chrono::high_resolution_clock::now();
-    double ms6 = chrono::duration<double, milli>(t1 - t0).count();
+        // pairwise Jaccard
+        pairs6 = 0;
+        for (size_t i = 0; i < hashSets6.size(); i++)
+            for (size_t j = i+1; j < hashSets6.size(); j++) {
+                computeJaccard(hashSets6[i], hashSets6[j]);
+                pairs6++;
+            }
+    });
+    double ms6 = median(runs6);
+    report.add("pipeline/6 real files", "ms", runs6);
 
     cout << "    6 real files  (" << pairs6 << " pairs)  : "
          << fixed << setprecision(2) << ms6 << " ms\n";
 
     // --- 50 synthetic files ---
-    auto t2 = chrono::high_resolution_clock::now();
-    resetVariableMap();
     vector<unordered_set<unsigned long>> hashSets50;
     vector<vector<string>> allKgrams50;
-    for (auto& raw : synthContents) {
-        string clean = normalizeSpacesAndLines(raw);
-        clean = removeComments(clean);
-        clean = normalizeVariables(clean);
-        auto tok = tokenize(clean);
-        auto kg  = createKGrams(tok, k);
-        allKgrams50.push_back(kg);
-        hashSets50.push_back(hashKGrams(kg));
-    }
     int pairs50 = 0;
-    for (size_t i = 0; i < hashSets50.size(); i++)
-        for (size_t j = i+1; j < hashSets50.size(); j++) {
-            computeJaccard(hashSets50[i], hashSets50[j]);
-            pairs50++;
+    vector<double> runs50 = timeRuns(reps, [&] {
+        resetVariableMap();
+        hashSets50.clear();
+        allKgrams50.clear();
+        for (auto& raw : synthContents) {
+            string clean = normalizeSpacesAndLines(raw);
+            clean = removeComments(clean);
+            clean = normalizeVariables(clean);
+            auto tok = tokenize(clean);
+            auto kg  = createKGrams(tok, k);
+            allKgrams50.push_back(kg);
+            hashSets50.push_back(hashKGrams(kg));
         }
-    auto t3 = chrono::high_resolution_clock::now();
-    double ms50 = chrono::duration<double, milli>(t3 - t2).count();
+        pairs50 = 0;
+        for (size_t i = 0; i < hashSets50.size(); i++)
+            for (size_t j = i+1; j < hashSets50.size(); j++) {
+                computeJaccard(hashSets50[i], hashSets50[j]);
+                pairs50++;
+            }
+    });
+    double ms50 = median(runs50);
+    report.add("pipeline/50 synth files", "ms", runs50);
 
     cout << "    50 synth files (" << pairs50 << " pairs) : "
          << fixed << setprecision(2) << ms50 << " ms\n\n";
 
     // ------------------------------------------------------------------
-    // 4.  MEMORY USAGE
+    // 4.  MEMORY USAGE  (process peak, then stage by stage on the 50 files)
     // ------------------------------------------------------------------
-    size_t peakKB = getPeakMemoryKB();
+    ResourceSnapshot afterRuns = sampleResources();
+    size_t peakKB = afterRuns.peakRssKB;
+
+    // Every rep runs each stage once, in order, from the same input. The first rep
+    // supplies the memory, counter and allocation figures; the times are the median
+    vector<StageUsage> stages;
+    vector<vector<double>> stageRuns;
+    for (int r = 0; r < reps; r++) {
+        resetVariableMap();
+        vector<string> stageText = synthContents;
+        vector<vector<string>> stageTokens, stageKgrams;
+        vector<unordered_set<unsigned long>> stageHashes;
+        vector<StageUsage> run;
+        run.push_back(measureStage("normalizeSpacesAndLines", [&] {
+            for (auto& text : stageText) text = normalizeSpacesAndLines(text);
+        }));
+        run.push_back(measureStage("removeComments", [&] {
+            for (auto& text : stageText) text = removeComments(text);
+        }));
+        run.push_back(measureStage("normalizeVariables", [&] {
+            for (auto& text : stageText) text = normalizeVariables(text);
+        }));
+        run.push_back(measureStage("tokenize", [&] {
+            for (auto& text : stageText) stageTokens.push_back(tokenize(text));
+        }));
+        run.push_back(measureStage("createKGrams", [&] {
+            for (auto& tok : stageTokens) stageKgrams.push_back(createKGrams(tok, k));
+        }));
+        run.push_back(measureStage("hashKGrams", [&] {
+            for (auto& kg : stageKgrams) stageHashes.push_back(hashKGrams(kg));
+        }));
+        vector<double> stageSimilarities;  // kept so the comparisons are not optimized away
+        run.push_back(measureStage("Jaccard (all pairs)", [&] {
+            for (size_t i = 0; i < stageHashes.size(); i++)
+                for (size_t j = i+1; j < stageHashes.size(); j++)
+                    stageSimilarities.push_back(computeJaccard(stageHashes[i], stageHashes[j]));
+        }));
+        if (r == 0) {
+            stages = run;
+            stageRuns.resize(run.size());
+            stageCounters.reset();
+            countStageAllocs = false;
+        }
+        for (size_t s = 0; s < run.size(); s++) {
+            stageRuns[s].push_back(run[s].ms);
+            peakKB = max(peakKB, run[s].after.peakRssKB);
+        }
+    }
+    for (size_t s = 0; s < stages.size(); s++) {
+        stages[s].ms = median(stageRuns[s]);
+        report.add("stage/" + stages[s].stage, "ms", stageRuns[s]);
+    }
+    if (afterRuns.available) report.add("memory/peak RSS", "KB", static_cast<double>(peakKB));
+
     cout << "[3] PEAK MEMORY\n";
-    if (peakKB > 0)
-        cout << "    Peak working set : " << fixed << setprecision(2) << (peakKB / 1024.0) << " MB\n\n";
-    else
-        cout << "    (Memory measurement not available on this platform)\n\n";
+    if (afterRuns.available) {
+        cout << "    Peak RSS         : " << fixed << setprecision(2) << (peakKB / 1024.0) << " MB\n";
+        cout << "    Current RSS      : " << fixed << setprecision(2) << (sampleResources().currentRssKB / 1024.0) << " MB\n";
+    } else {
+        cout << "    (Memory measurement not available on this platform)\n";
+    }
+    cout << "    Per stage (" << NUM_SYNTHETIC << " synth files, one stage at a time"
+         << (reps > 1 ? ", median of " + to_string(reps) + " runs" : string()) << "):\n";
+    if (perf) cout << "    Hardware counters: " << counterStatus << "\n";
+    if (alloc && !allocCountingAvailable()) cout << "    Allocations: " << describeAllocStats({}) << "\n";
+    for (size_t s = 0; s < stages.size(); s++) {
+        cout << "      " << left << setw(24) << stages[s].stage << right << describeStageUsage(stages[s]) << "\n";
+        if (s < stageCounts.size()) {
+            cout << "      " << setw(24) << "" << "  " << describePerfSample(stageCounts[s]) << "\n";
+            for (int e = 0; e < PERF_EVENT_COUNT; e++)
+                if (stageCounts[s].valid[e])
+                    report.add("counters/" + stages[s].stage + "/" + perfEventName(PerfEvent(e)), "count", stageCounts[s].count[e]);
+        }
+        if (s < stageAllocs.size()) {
+            const AllocStats& a = stageAllocs[s];
+            cout << "      " << setw(24) << "" << "  " << describeAllocStats(a) << "\n";
+            report.add("allocs/" + stages[s].stage + "/allocations", "count", static_cast<double>(a.allocations));
+            report.add("allocs/" + stages[s].stage + "/allocated bytes", "B", static_cast<double>(a.bytes));
+            report.add("allocs/" + stages[s].stage + "/peak live bytes", "B", static_cast<double>(a.peakLiveBytes));
+        }
+    }
+    cout << "\n";
 
     // ------------------------------------------------------------------
     // 5.  K-GRAM PARAMETERS
@@ -358,20 +380,22 @@ int main() {
     cout << "    Baseline: O(n^2) string comparison using std::set<string> Jaccard\n";
 
     // Brute-force on 6 real files
-    auto bf0 = chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < allKgrams6.size(); i++)
-        for (size_t j = i+1; j < allKgrams6.size(); j++)
-            bruteForceJaccard(allKgrams6[i], allKgrams6[j]);
-    auto bf1 = chrono::high_resolution_clock::now();
-    double bfMs6 = chrono::duration<double, milli>(bf1 - bf0).count();
+    vector<double> bfRuns6 = timeRuns(reps, [&] {
+        for (size_t i = 0; i < allKgrams6.size(); i++)
+            for (size_t j = i+1; j < allKgrams6.size(); j++)
+                exactJaccard(allKgrams6[i], allKgrams6[j]);
+    });
+    double bfMs6 = median(bfRuns6);
 
     // Hash-based on 6 real files (just the Jaccard part, hashes already built)
-    auto hb0 = chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < hashSets6.size(); i++)
-        for (size_t j = i+1; j < hashSets6.size(); j++)
-            computeJaccard(hashSets6[i], hashSets6[j]);
-    auto hb1 = chrono::high_resolution_clock::now();
-    double hbMs6 = chrono::duration<double, milli>(hb1 - hb0).count();
+    vector<double> hbRuns6 = timeRuns(reps, [&] {
+        for (size_t i = 0; i < hashSets6.size(); i++)
+            for (size_t j = i+1; j < hashSets6.size(); j++)
+                computeJaccard(hashSets6[i], hashSets6[j]);
+    });
+    double hbMs6 = median(hbRuns6);
+    report.add("jaccard/brute-force 6 files", "ms", bfRuns6);
+    report.add("jaccard/hash-based 6 files", "ms", hbRuns6);
 
     cout << "    6 files — brute-force Jaccard : " << fixed << setprecision(3) << bfMs6 << " ms\n";
     cout << "    6 files — hash-based  Jaccard : " << fixed << setprecision(3) << hbMs6 << " ms\n";
@@ -379,19 +403,26 @@ int main() {
         cout << "    Speedup ratio (6 files)       : " << fixed << setprecision(1) << (bfMs6 / hbMs6) << "x\n";
 
     // Brute-force on 50 synthetic files
-    auto bf2 = chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < allKgrams50.size(); i++)
-        for (size_t j = i+1; j < allKgrams50.size(); j++)
-            bruteForceJaccard(allKgrams50[i], allKgrams50[j]);
-    auto bf3 = chrono::high_resolution_clock::now();
-    double bfMs50 = chrono::duration<double, milli>(bf3 - bf2).count();
-
-    auto hb2 = chrono::high_resolution_clock::now();
-    for (size_t i = 0; i < hashSets50.size(); i++)
-        for (size_t j = i+1; j < hashSets50.size(); j++)
-            computeJaccard(hashSets50[i], hashSets50[j]);
-    auto hb3 = chrono::high_resolution_clock::now();
-    double hbMs50 = chrono::duration<double, milli>(hb3 - hb2).count();
+    vector<double> bfRuns50 = timeRuns(reps, [&] {
+        for (size_t i = 0; i < allKgrams50.size(); i++)
+            for (size_t j = i+1; j < allKgrams50.size(); j++)
+                exactJaccard(allKgrams50[i], allKgrams50[j]);
+    });
+    double bfMs50 = median(bfRuns50);
+
+    vector<double> hbRuns50 = timeRuns(reps, [&] {
+        for (size_t i = 0; i < hashSets50.size(); i++)
+            for (size_t j = i+1; j < hashSets50.size(); j++)
+                computeJaccard(hashSets50[i], hashSets50[j]);
+    });
+    double hbMs50 = median(hbRuns50);
+    report.add("jaccard/brute-force 50 files", "ms", bfRuns50);
+    report.add("jaccard/hash-based 50 files", "ms", hbRuns50);
+    // One speedup per rep, so the ratio is tested like the timings it comes from
+    vector<double> speedups50;
+    for (int r = 0; r < reps; r++)
+        if (hbRuns50[r] > 0) speedups50.push_back(bfRuns50[r] / hbRuns50[r]);
+    if (!speedups50.empty()) report.add("jaccard/speedup 50 files", "x", speedups50, false);
 
     cout << "    50 files — brute-force Jaccard: " << fixed << setprecision(3) << bfMs50 << " ms\n";
     cout << "    50 files — hash-based  Jaccard: " << fixed << setprecision(3) << hbMs50 << " ms\n";
@@ -470,10 +501,20 @@ int main() {
     cout << "    True Positive Rate  : " << fixed << setprecision(1) << (tpRate * 100) << "%\n";
     cout << "    Precision           : " << fixed << setprecision(1) << (precision * 100) << "%\n";
     cout << "    F1 Score            : " << fixed << setprecision(2) << f1 << "\n";
+    report.add("accuracy/true positive rate", "ratio", tpRate, false);
+    report.add("accuracy/precision", "ratio", precision, false);
+    report.add("accuracy/F1", "ratio", f1, false);
 
     cout << "\n========================================================\n";
     cout << "  Benchmark complete.\n";
     cout << "========================================================\n";
 
+    if (!jsonPath.empty()) {
+        if (!report.save(jsonPath)) {
+            cerr << "Error: cannot write " << jsonPath << "\n";
+            return 1;
+        }
+        cout << "Results written to " << jsonPath << "\n";
+    }
     return 0;
 }
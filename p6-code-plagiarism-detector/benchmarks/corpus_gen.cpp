@@ -0,0 +1,538 @@
+/**
+ * Synthetic Plagiarism Corpus Generator
+ * =====================================
+ * Writes a corpus of generated C++ programs in which some files are plagiarized
+ * from others, together with the ground truth, so throughput and
+ * precision/recall can be measured on the same run at any scale (10k–1M files).
+ *
+ * Every original is a fresh random program: prototypes, then 3–8 functions of
+ * declarations, loops, conditionals and calls. A derived file copies an earlier
+ * original and applies a random, non-empty set of labelled obfuscations:
+ *   rename    new names for every variable, parameter and function
+ *   reformat  other indentation, brace placement, operator spacing, blank lines, comments
+ *   reorder   functions in another order, independent declarations shuffled
+ *   deadcode  unused locals, never-taken branches and an unused function added
+ *   partial   only 30–70% of the functions copied, into an otherwise new program
+ *
+ * Output (DIR):
+ *   files/NNN/NNNNNN.cpp  the corpus, 1000 files per directory
+ *   files.txt             every file, one path per line (relative to DIR)
+ *   ground_truth.tsv      every plagiarized pair; pairs not listed are unrelated
+ *     file_a  file_b  relation  transformations  copied_fraction
+ *       relation "derived":       file_b was made from the original file_a
+ *       relation "common-source": both were made from the same original
+ *
+ * Compile: g++ -O2 -std=c++20 -o corpus_gen corpus_gen.cpp   (or the `corpus_gen` CMake target)
+ * Run:     ./corpus_gen DIR [--files N] [--seed S] [--copy-rate R] [--max-copies M]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <vector>
+#include <deque>
+#include <algorithm>
+#include <charconv>
+#include <iomanip>
+#include <chrono>
+#include <random>
+#include <filesystem>
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct GeneratorOptions {
+    fs::path outputDir;
+    long long files = 10000;
+    uint64_t seed = 1;
+    double copyRate = 0.3; // share of files derived from an earlier original
+    int maxCopies = 4;     // derived files per original at most
+};
+
+// ================================================
+//  PROGRAM MODEL
+// ================================================
+// Statements are token templates: "@N" is variable N of the function, "#N" is
+// function N of the program. Names are bound only when a file is rendered, so
+// renaming and reformatting never touch the structure.
+
+struct Statement {
+    vector<string> lines;  // "{" at the end of a line opens a block, a lone "}" closes it
+    bool movable = false;  // a declaration that depends on nothing before it
+};
+
+struct Function {
+    int id;                // index into the program's function names
+    int paramCount;
+    int varCount;          // parameters first, then locals
+    vector<Statement> body;
+};
+
+struct Program {
+    vector<Function> functions;
+    vector<string> functionNames;
+    vector<vector<string>> varNames; // per function id
+};
+
+struct Style {
+    string indent = "    ";
+    bool braceOnNewLine = false;
+    bool compactOperators = false;
+    bool blankLineBetweenStatements = false;
+    bool comments = false;
+};
+
+const char* const WORDS[] = {"count", "total", "sum", "value", "index", "result", "temp", "data", "item", "limit",
+                             "size", "score", "level", "step", "offset", "width", "height", "delta", "rate", "node",
+                             "key", "left", "right", "low", "high", "mid", "acc", "base", "factor", "buffer"};
+const char* const VERBS[] = {"compute", "update", "find", "scan", "merge", "check", "build", "reduce", "apply", "count"};
+const char* const COMMENTS[] = {"// update the running value", "// edge case", "// main loop", "// TODO: simplify",
+                                "// accumulate", "// bounds check", "/* helper */"};
+const char* const TYPES[] = {"int", "double", "float"};
+
+template <size_t N>
+const char* pick(mt19937_64& rng, const char* const (&list)[N]) {
+    return list[rng() % N];
+}
+
+int uniform(mt19937_64& rng, int low, int high) {
+    return low + static_cast<int>(rng() % static_cast<uint64_t>(high - low + 1));
+}
+
+// A fresh set of names: camelCase or snake_case words, sometimes numbered
+void nameProgram(Program& program, mt19937_64& rng) {
+    bool snake = rng() % 2;
+    auto join = [&](const string& a, const string& b) {
+        if (snake) return a + "_" + b;
+        string upper = b;
+        upper[0] = static_cast<char>(toupper(upper[0]));
+        return a + upper;
+    };
+
+    int ids = 0;
+    for (const Function& function : program.functions) ids = max(ids, function.id + 1);
+    program.functionNames.clear();
+    for (int f = 0; f < ids; ++f) {
+        program.functionNames.push_back(join(pick(rng, VERBS), pick(rng, WORDS)) + to_string(f));
+    }
+    program.varNames.assign(ids, {});
+    for (const Function& function : program.functions) {
+        vector<string>& names = program.varNames[function.id];
+        for (int v = 0; v < function.varCount; ++v) {
+            string name = rng() % 3 == 0 ? join(pick(rng, WORDS), pick(rng, WORDS)) : string(pick(rng, WORDS));
+            names.push_back(name + (rng() % 2 ? to_string(v) : "_" + to_string(v)));
+        }
+    }
+}
+
+Statement makeStatement(mt19937_64& rng, const Function& function) {
+    auto var = [&] { return "@" + to_string(rng() % function.varCount); };
+    auto number = [&] { return to_string(uniform(rng, 1, 99)); };
+    Statement s;
+    switch (rng() % 5) {
+    case 0: {
+        string target = var();
+        s.lines = {target + " = " + target + " + " + var() + " * " + number() + " ;"};
+        break;
+    }
+    case 1:
+        s.lines = {"for ( int i = 0 ; i < " + var() + " ; i ++ ) {", var() + " += i ;", "}"};
+        break;
+    case 2: {
+        string target = var();
+        s.lines = {"if ( " + target + " > " + number() + " ) {", target + " = " + target + " % " + number() + " ;", "}"};
+        break;
+    }
+    case 3:
+        if (function.id > 0) { // calls go to functions with a smaller id
+            s.lines = {var() + " = #" + to_string(rng() % function.id) + " ( " + var() + " ) ;"};
+            break;
+        }
+        [[fallthrough]];
+    default:
+        s.lines = {"while ( " + var() + " > " + number() + " ) {", var() + " -- ;", "}"};
+        break;
+    }
+    return s;
+}
+
+Function makeFunction(mt19937_64& rng, int id) {
+    Function function;
+    function.id = id;
+    function.paramCount = uniform(rng, 1, 3);
+    int locals = uniform(rng, 2, 5);
+    function.varCount = function.paramCount + locals;
+    for (int v = function.paramCount; v < function.varCount; ++v) {
+        Statement declaration;
+        declaration.lines = {string(pick(rng, TYPES)) + " @" + to_string(v) + " = " + to_string(uniform(rng, 0, 50)) + " ;"};
+        declaration.movable = true;
+        function.body.push_back(declaration);
+    }
+    int statements = uniform(rng, 4, 12);
+    for (int i = 0; i < statements; ++i) {
+        function.body.push_back(makeStatement(rng, function));
+    }
+    function.body.push_back({{"return @" + to_string(rng() % function.varCount) + " ;"}, false});
+    return function;
+}
+
+Program makeOriginal(mt19937_64& rng) {
+    Program program;
+    int count = uniform(rng, 3, 8);
+    for (int f = 0; f < count; ++f) {
+        program.functions.push_back(makeFunction(rng, f));
+    }
+    nameProgram(program, rng);
+    return program;
+}
+
+// ================================================
+//  OBFUSCATIONS
+// ================================================
+
+void reorder(Program& program, mt19937_64& rng) {
+    shuffle(program.functions.begin(), program.functions.end(), rng);
+    for (Function& function : program.functions) {
+        auto firstFixed = find_if(function.body.begin(), function.body.end(), [](const Statement& s) { return !s.movable; });
+        shuffle(function.body.begin(), firstFixed, rng);
+    }
+}
+
+void insertDeadCode(Program& program, mt19937_64& rng) {
+    for (Function& function : program.functions) {
+        int insertions = uniform(rng, 1, 3);
+        for (int i = 0; i < insertions; ++i) {
+            Statement dead;
+            if (rng() % 2) {
+                int v = function.varCount++;
+                dead.lines = {"int @" + to_string(v) + " = " + to_string(uniform(rng, 0, 9)) + " ;"};
+            } else {
+                dead.lines = {"if ( false ) {", "@0 = @0 + 1 ;", "}"};
+            }
+            // Somewhere between the first statement and the return
+            size_t at = 1 + rng() % (function.body.size() - 1);
+            function.body.insert(function.body.begin() + at, dead);
+        }
+    }
+    // An unused function with no calls out, so any id is safe
+    Function unused = makeFunction(rng, 0);
+    unused.id = static_cast<int>(program.functionNames.size());
+    program.functions.push_back(unused);
+    program.functionNames.push_back("unused" + string(pick(rng, WORDS)));
+    program.varNames.push_back({});
+    for (int v = 0; v < unused.varCount; ++v) program.varNames.back().push_back(string(pick(rng, WORDS)) + to_string(v));
+}
+
+// Names for variables a transformation added after the program was named
+void nameNewVariables(Program& program) {
+    for (const Function& function : program.functions) {
+        vector<string>& names = program.varNames[function.id];
+        while (static_cast<int>(names.size()) < function.varCount) names.push_back("unused" + to_string(names.size()));
+    }
+}
+
+// Keep `fraction` of source's functions (and what they call) inside a new program
+Program partialCopy(const Program& source, double fraction, mt19937_64& rng) {
+    vector<bool> keep(source.functionNames.size(), false);
+    for (const Function& function : source.functions) {
+        if (uniform(rng, 0, 999) < fraction * 1000) keep[function.id] = true;
+    }
+    if (find(keep.begin(), keep.end(), true) == keep.end()) keep[source.functions[rng() % source.functions.size()].id] = true;
+    // Callees first: a function is only kept with every function it calls
+    for (int id = static_cast<int>(keep.size()) - 1; id >= 0; --id) {
+        if (!keep[id]) continue;
+        for (const Function& function : source.functions) {
+            if (function.id != id) continue;
+            for (const Statement& s : function.body) {
+                for (const string& line : s.lines) {
+                    for (size_t at = line.find('#'); at != string::npos; at = line.find('#', at + 1)) {
+                        keep[stoi(line.substr(at + 1))] = true;
+                    }
+                }
+            }
+        }
+    }
+
+    Program result = makeOriginal(rng);
+    int offset = static_cast<int>(result.functionNames.size());
+    for (const Function& function : source.functions) {
+        if (!keep[function.id]) continue;
+        Function copy = function;
+        copy.id += offset;
+        for (Statement& s : copy.body) {
+            for (string& line : s.lines) {
+                string shifted;
+                for (size_t i = 0; i < line.size(); ++i) {
+                    if (line[i] != '#') {
+                        shifted += line[i];
+                        continue;
+                    }
+                    size_t end = i + 1;
+                    while (end < line.size() && isdigit(static_cast<unsigned char>(line[end]))) ++end;
+                    shifted += "#" + to_string(stoi(line.substr(i + 1, end - i - 1)) + offset);
+                    i = end - 1;
+                }
+                line = shifted;
+            }
+        }
+        result.functions.push_back(copy);
+    }
+    result.functionNames.resize(offset + source.functionNames.size());
+    result.varNames.resize(offset + source.functionNames.size());
+    for (size_t id = 0; id < source.functionNames.size(); ++id) {
+        result.functionNames[offset + id] = source.functionNames[id];
+        result.varNames[offset + id] = source.varNames[id];
+    }
+    return result;
+}
+
+// ================================================
+//  RENDERING
+// ================================================
+
+bool isOperator(string_view token) {
+    return token == "=" || token == "+" || token == "-" || token == "*" || token == "%" || token == "<" ||
+           token == ">" || token == "+=" || token == "-=" || token == "==" || token == "<=" || token == ">=";
+}
+
+// N of an "@N" or "#N" placeholder
+size_t placeholderIndex(string_view token) {
+    size_t index = 0;
+    from_chars(token.data() + 1, token.data() + token.size(), index);
+    return index;
+}
+
+string renderLine(const string& line, const Program& program, int functionId, const Style& style) {
+    // Templates are single-space separated
+    vector<string_view> tokens;
+    for (size_t begin = 0; begin < line.size();) {
+        size_t end = line.find(' ', begin);
+        if (end == string::npos) end = line.size();
+        string_view token(line.data() + begin, end - begin);
+        if (token[0] == '@') token = program.varNames[functionId][placeholderIndex(token)];
+        else if (token[0] == '#') token = program.functionNames[placeholderIndex(token)];
+        tokens.push_back(token);
+        begin = end + 1;
+    }
+
+    string out;
+    for (size_t i = 0; i < tokens.size(); ++i) {
+        string_view t = tokens[i];
+        if (i > 0) {
+            string_view prev = tokens[i - 1];
+            bool tight = t == ";" || t == ")" || prev == "(" || t == "++" || t == "--" ||
+                         (t == "(" && prev != "for" && prev != "if" && prev != "while");
+            if (style.compactOperators && (isOperator(t) || isOperator(prev))) tight = true;
+            if (!tight) out += ' ';
+        }
+        out += t;
+    }
+    return out;
+}
+
+string render(const Program& program, const Style& style, mt19937_64& rng) {
+    string out = "#include <iostream>\nusing namespace std;\n\n";
+    vector<const Function*> byId(program.functionNames.size(), nullptr);
+    for (const Function& function : program.functions) byId[function.id] = &function;
+
+    auto signature = [&](const Function& function) {
+        string s = "int " + program.functionNames[function.id] + "(";
+        for (int p = 0; p < function.paramCount; ++p) {
+            s += (p ? ", int " : "int ") + program.varNames[function.id][p];
+        }
+        return s + ")";
+    };
+    // Prototypes let the functions appear in any order
+    for (const Function& function : program.functions) out += signature(function) + ";\n";
+    out += "\n";
+
+    for (const Function& function : program.functions) {
+        if (style.comments && rng() % 2) out += string(pick(rng, COMMENTS)) + "\n";
+        out += signature(function) + (style.braceOnNewLine ? "\n{\n" : " {\n");
+        int depth = 1;
+        for (const Statement& statement : function.body) {
+            for (const string& line : statement.lines) {
+                if (line == "}") --depth;
+                string indent;
+                for (int d = 0; d < depth; ++d) indent += style.indent;
+                string text = renderLine(line, program, function.id, style);
+                bool opens = text.back() == '{';
+                if (opens && style.braceOnNewLine) {
+                    text.pop_back();
+                    while (!text.empty() && text.back() == ' ') text.pop_back();
+                    out += indent + text + "\n" + indent + "{\n";
+                } else {
+                    out += indent + text + "\n";
+                }
+                if (opens) ++depth;
+            }
+            if (style.comments && rng() % 6 == 0) out += style.indent + pick(rng, COMMENTS) + "\n";
+            if (style.blankLineBetweenStatements) out += "\n";
+        }
+        out += "}\n\n";
+    }
+
+    out += "int main() {\n" + style.indent + "cout << " + program.functionNames[program.functions.front().id] + "(";
+    for (int p = 0; p < program.functions.front().paramCount; ++p) out += p ? ", 1" : "1";
+    out += ") << endl;\n" + style.indent + "return 0;\n}\n";
+    return out;
+}
+
+Style randomStyle(mt19937_64& rng) {
+    Style style;
+    const char* const indents[] = {"  ", "    ", "\t", "   "};
+    style.indent = pick(rng, indents);
+    style.braceOnNewLine = rng() % 2;
+    style.compactOperators = rng() % 2;
+    style.blankLineBetweenStatements = rng() % 3 == 0;
+    style.comments = true;
+    return style;
+}
+
+// ================================================
+//  CORPUS
+// ================================================
+
+struct FamilyMember {
+    string path;
+    string transformations;
+    double copiedFraction;
+};
+
+// An original that later files may still be derived from
+struct Family {
+    string path;
+    Program program;
+    vector<FamilyMember> derived;
+};
+
+string filePath(long long index) {
+    ostringstream path;
+    path << "files/" << setw(3) << setfill('0') << index / 1000 << "/" << setw(6) << setfill('0') << index << ".cpp";
+    return path.str();
+}
+
+bool parseArguments(int argc, char* argv[], GeneratorOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--files" && hasValue) {
+            options.files = atoll(argv[++i]);
+        } else if (arg == "--seed" && hasValue) {
+            options.seed = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--copy-rate" && hasValue) {
+            options.copyRate = atof(argv[++i]);
+        } else if (arg == "--max-copies" && hasValue) {
+            options.maxCopies = atoi(argv[++i]);
+        } else if (arg[0] == '-' || !options.outputDir.empty()) {
+            return false;
+        } else {
+            options.outputDir = arg;
+        }
+    }
+    return !options.outputDir.empty() && options.files > 0 && options.copyRate >= 0 && options.copyRate < 1 &&
+           options.maxCopies > 0;
+}
+
+int main(int argc, char* argv[]) {
+    GeneratorOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " DIR [--files N] [--seed S] [--copy-rate R] [--max-copies M]\n";
+        return 1;
+    }
+
+    mt19937_64 rng(options.seed);
+    fs::create_directories(options.outputDir);
+    ofstream fileList(options.outputDir / "files.txt");
+    ofstream truth(options.outputDir / "ground_truth.tsv");
+    if (!fileList || !truth) {
+        cerr << "Error: cannot write to " << options.outputDir << "\n";
+        return 1;
+    }
+    truth << "file_a\tfile_b\trelation\ttransformations\tcopied_fraction\n";
+
+    // Originals derived files can still come from; older ones are retired so memory stays flat
+    const size_t OPEN_FAMILIES = 1000;
+    deque<Family> open;
+    long long originals = 0, derivedFiles = 0, pairs = 0, bytes = 0;
+    auto start = chrono::steady_clock::now();
+
+    for (long long index = 0; index < options.files; ++index) {
+        string path = filePath(index);
+        if (index % 1000 == 0) fs::create_directories(options.outputDir / fs::path(path).parent_path());
+
+        string code;
+        bool derive = !open.empty() && uniform(rng, 0, 999) < options.copyRate * 1000;
+        if (!derive) {
+            Family family{path, makeOriginal(rng), {}};
+            code = render(family.program, Style(), rng);
+            open.push_back(move(family));
+            if (open.size() > OPEN_FAMILIES) open.pop_front();
+            ++originals;
+        } else {
+            size_t chosen = rng() % open.size();
+            Family& family = open[chosen];
+            Program copy = family.program;
+            vector<string> applied;
+            double fraction = 1.0;
+            bool partial = rng() % 5 == 0;
+            int mask = 0;
+            while (mask == 0 && !partial) mask = rng() % 16;
+            if (partial) mask = rng() % 16;
+
+            if (partial) {
+                fraction = uniform(rng, 30, 70) / 100.0;
+                copy = partialCopy(copy, fraction, rng);
+                applied.push_back("partial");
+            }
+            if (mask & 1) {
+                nameProgram(copy, rng);
+                applied.push_back("rename");
+            }
+            if (mask & 4) {
+                reorder(copy, rng);
+                applied.push_back("reorder");
+            }
+            if (mask & 8) {
+                insertDeadCode(copy, rng);
+                nameNewVariables(copy);
+                applied.push_back("deadcode");
+            }
+            Style style;
+            if (mask & 2) {
+                style = randomStyle(rng);
+                applied.push_back("reformat");
+            }
+            code = render(copy, style, rng);
+
+            string labels;
+            for (const string& label : applied) labels += (labels.empty() ? "" : ",") + label;
+            truth << family.path << "\t" << path << "\tderived\t" << labels << "\t" << fraction << "\n";
+            for (const FamilyMember& sibling : family.derived) {
+                truth << sibling.path << "\t" << path << "\tcommon-source\t" << sibling.transformations << "+" << labels
+                      << "\t" << min(sibling.copiedFraction, fraction) << "\n";
+            }
+            pairs += 1 + family.derived.size();
+            family.derived.push_back({path, labels, fraction});
+            if (static_cast<int>(family.derived.size()) >= options.maxCopies) {
+                if (chosen + 1 != open.size()) swap(family, open.back());
+                open.pop_back();
+            }
+            ++derivedFiles;
+        }
+
+        ofstream(options.outputDir / path, ios::binary) << code;
+        fileList << path << "\n";
+        bytes += code.size();
+    }
+
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << "Wrote " << options.files << " files (" << originals << " originals, " << derivedFiles << " derived) to "
+         << options.outputDir.string() << "\n";
+    cout << "Ground truth: " << pairs << " plagiarized pairs in ground_truth.tsv\n";
+    cout << fixed << setprecision(1) << bytes / 1048576.0 << " MB in " << setprecision(2) << seconds << " s ("
+         << setprecision(0) << options.files / max(seconds, 1e-9) << " files/s)\n";
+    return 0;
+}
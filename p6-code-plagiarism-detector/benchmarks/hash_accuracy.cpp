@@ -0,0 +1,366 @@
+/**
+ * Hash-Collision and Accuracy Harness
+ * ===================================
+ * How much do the k-gram hash and the fingerprint representation cost in
+ * accuracy, and what do they buy in speed? Exact string-set Jaccard
+ * (JaccardOracle, jaccard_oracle.h) is the ground truth.
+ *
+ *   [1] COLLISIONS  Hashes --universe distinct k-gram strings with every hash
+ *                   function and counts the k-grams whose value an earlier one
+ *                   already took, next to the birthday-bound expectation for
+ *                   the function's output space. simpleHash() reduces mod
+ *                   10^9+7 (about 30 bits), so an archive with millions of
+ *                   distinct k-grams is certain to have false overlaps.
+ *   [2] ACCURACY    Estimates the similarity of every document pair with each
+ *                   estimator (a hash function plus a full hash set or a
+ *                   bottom-k sketch) and reports the error against the oracle,
+ *                   the pairs whose verdict at --threshold flips, the false
+ *                   shared k-grams and the build and compare time.
+ *
+ * Documents are families of token streams mutated at different rates, so the
+ * pairs cover the whole similarity range; --corpus takes the first --docs files
+ * of a corpus_gen directory through the real pipeline instead.
+ *
+ * Build:  cmake --build build --target hash_accuracy
+ * Run:    ./hash_accuracy [--universe N] [--docs N] [--tokens T] [--k K] [--threshold J]
+ *                         [--max-pairs P] [--seed S] [--corpus DIR] [--json FILE]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <random>
+#include <filesystem>
+#include "pipeline.h"
+#include "digest.h"
+#include "jaccard_oracle.h"
+#include "bench_report.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct AccuracyOptions {
+    size_t universe = 2'000'000;  // distinct k-grams hashed in [1]
+    size_t docs = 200;
+    size_t tokens = 2000;         // per generated document
+    int k = 3;
+    double threshold = 0.25;      // the plagiarism cut-off used by benchmark.cpp
+    size_t maxPairs = 200'000;
+    unsigned seed = 1;
+    string corpusDir, jsonPath;
+};
+
+// ================================================
+//  HASH FUNCTIONS AND ESTIMATORS
+// ================================================
+struct HashFunction {
+    const char* name;
+    double space;                 // number of possible values
+    uint64_t (*hash)(const string&);
+};
+
+const HashFunction HASH_FUNCTIONS[] = {
+    {"simpleHash", 1000000007.0, [](const string& s) -> uint64_t { return simpleHash(s); }},
+    {"std::hash", pow(2.0, 8 * sizeof(size_t)), [](const string& s) -> uint64_t { return std::hash<string>{}(s); }},
+    {"digest64", pow(2.0, 64), [](const string& s) -> uint64_t { return digestString(s); }},
+    {"digest32", pow(2.0, 32), [](const string& s) -> uint64_t { return digestString(s) & 0xFFFFFFFFu; }},
+};
+
+// A full set of hashes (as project6 stores fingerprints) or the `sketchSize`
+// smallest distinct hashes of a document (a bottom-k MinHash sketch)
+struct Estimator {
+    string name;
+    const HashFunction* function;
+    size_t sketchSize;            // 0: full set
+};
+
+vector<Estimator> estimators() {
+    vector<Estimator> list;
+    for (const HashFunction& f : HASH_FUNCTIONS) list.push_back({string("set/") + f.name, &f, 0});
+    list.push_back({"bottom-64/digest64", &HASH_FUNCTIONS[2], 64});
+    list.push_back({"bottom-256/digest64", &HASH_FUNCTIONS[2], 256});
+    list.push_back({"bottom-256/simpleHash", &HASH_FUNCTIONS[0], 256});
+    return list;
+}
+
+// Jaccard of two bottom-k sketches: of the s smallest hashes of A ∪ B, the
+// fraction present in both
+double sketchJaccard(const vector<uint64_t>& A, const vector<uint64_t>& B, size_t s) {
+    size_t i = 0, j = 0, taken = 0, shared = 0;
+    while (taken < s && (i < A.size() || j < B.size())) {
+        if (j == B.size() || (i < A.size() && A[i] < B[j])) {
+            i++;
+        } else if (i == A.size() || B[j] < A[i]) {
+            j++;
+        } else {
+            shared++;
+            i++;
+            j++;
+        }
+        taken++;
+    }
+    return taken == 0 ? 1.0 : static_cast<double>(shared) / taken;
+}
+
+// ================================================
+//  [1] COLLISIONS
+// ================================================
+// `count` distinct 3-token strings shaped like normalized k-grams: an
+// invertible stride walk over vocabulary^3, so no two are equal
+vector<string> kgramUniverse(size_t count) {
+    vector<string> vocabulary = {"int", "double", "for", "if", "while", "return", "(", ")", "{", "}", "[", "]",
+                                 ";", ",", "=", "+", "-", "*", "/", "%", "<", ">", "<=", ">=", "==", "!=",
+                                 "++", "--", "cout", "endl", "<<", "0", "1", "2", "10", "100", "vector", "size"};
+    for (int v = 1; vocabulary.size() < 2000; v++) vocabulary.push_back("var" + to_string(v));
+    const uint64_t V = vocabulary.size(), combinations = V * V * V;
+    const uint64_t stride = 2654435761ULL; // coprime with 2000^3 = 2^12 * 5^9
+    vector<string> universe;
+    universe.reserve(count);
+    for (uint64_t i = 0; i < min<uint64_t>(count, combinations); i++) {
+        uint64_t x = static_cast<uint64_t>((static_cast<unsigned __int128>(i) * stride) % combinations);
+        universe.push_back(vocabulary[x / (V * V)] + " " + vocabulary[x / V % V] + " " + vocabulary[x % V]);
+    }
+    return universe;
+}
+
+// Items expected to land on a value an earlier item already took: N - E[distinct]
+double expectedCollisions(double items, double space) {
+    if (items / space < 1e-6) return items * items / (2 * space); // avoids cancellation
+    return items - space * -expm1(items * log1p(-1 / space));
+}
+
+void reportCollisions(const AccuracyOptions& options, BenchReport& report) {
+    vector<string> universe = kgramUniverse(options.universe);
+    cout << "[1] COLLISIONS over " << universe.size() << " distinct k-grams\n";
+    cout << "    " << left << setw(14) << "hash" << right << setw(8) << "bits" << setw(13) << "colliding"
+         << setw(12) << "rate" << setw(13) << "expected" << setw(11) << "ns/hash" << "\n";
+
+    vector<uint64_t> values(universe.size());
+    for (const HashFunction& f : HASH_FUNCTIONS) {
+        auto start = chrono::steady_clock::now();
+        for (size_t i = 0; i < universe.size(); i++) values[i] = f.hash(universe[i]);
+        double ns = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / max<size_t>(1, universe.size());
+
+        sort(values.begin(), values.end());
+        size_t distinct = unique(values.begin(), values.end()) - values.begin();
+        size_t colliding = universe.size() - distinct;
+        double rate = universe.empty() ? 0 : static_cast<double>(colliding) / universe.size();
+
+        cout << "    " << left << setw(14) << f.name << right << fixed << setprecision(1) << setw(8) << log2(f.space)
+             << setw(13) << colliding << setw(11) << setprecision(6) << rate * 100 << "%" << setw(13) << setprecision(1)
+             << expectedCollisions(universe.size(), f.space) << setw(11) << setprecision(2) << ns << "\n";
+        report.add(string("collisions/") + f.name, "k-grams", static_cast<double>(colliding));
+        report.add(string("hash time/") + f.name, "ns", ns);
+    }
+    cout << "\n";
+}
+
+// ================================================
+//  [2] ACCURACY
+// ================================================
+// Families of random token streams; each member replaces every token with a
+// random one at its own rate in [0, 0.5]
+vector<vector<string>> generateDocuments(const AccuracyOptions& options) {
+    mt19937_64 rng(options.seed);
+    vector<string> vocabulary = {"int", "for", "if", "return", "(", ")", "{", "}", ";", "=", "+", "<", "++", "cout", "<<"};
+    for (int v = 1; vocabulary.size() < 2000; v++) vocabulary.push_back("var" + to_string(v));
+    uniform_int_distribution<size_t> token(0, vocabulary.size() - 1);
+    uniform_real_distribution<double> unit(0, 1);
+
+    size_t families = max<size_t>(1, options.docs / 10);
+    vector<vector<string>> bases(families);
+    for (auto& base : bases)
+        for (size_t t = 0; t < options.tokens; t++) base.push_back(vocabulary[token(rng)]);
+
+    vector<vector<string>> documents;
+    for (size_t d = 0; d < options.docs; d++) {
+        vector<string> tokens = bases[d % families];
+        double rate = 0.5 * unit(rng);
+        for (auto& t : tokens)
+            if (unit(rng) < rate) t = vocabulary[token(rng)];
+        documents.push_back(createKGrams(tokens, options.k));
+    }
+    return documents;
+}
+
+// The first --docs files of a corpus_gen directory, each fingerprinted on its own
+vector<vector<string>> loadCorpus(const AccuracyOptions& options) {
+    vector<vector<string>> documents;
+    ifstream list(fs::path(options.corpusDir) / "files.txt");
+    string line;
+    while (documents.size() < options.docs && getline(list, line)) {
+        if (line.empty()) continue;
+        resetVariableMap();
+        documents.push_back(createKGrams(normalizeAndTokenize(readFile((fs::path(options.corpusDir) / line).string())), options.k));
+    }
+    resetVariableMap();
+    return documents;
+}
+
+struct ErrorSummary {
+    double bias = 0, meanAbs = 0, p50 = 0, p95 = 0, p99 = 0, max = 0;
+    double pairsWithError = 0, flipped = 0; // fractions of the pairs
+};
+
+ErrorSummary summarize(const vector<double>& estimates, const vector<double>& exact, double threshold) {
+    ErrorSummary s;
+    vector<double> absErrors;
+    for (size_t p = 0; p < estimates.size(); p++) {
+        double error = estimates[p] - exact[p];
+        s.bias += error;
+        absErrors.push_back(fabs(error));
+        if (fabs(error) > 1e-12) s.pairsWithError++;
+        if ((estimates[p] >= threshold) != (exact[p] >= threshold)) s.flipped++;
+    }
+    if (absErrors.empty()) return s;
+    size_t n = absErrors.size();
+    for (double e : absErrors) s.meanAbs += e;
+    sort(absErrors.begin(), absErrors.end());
+    auto quantile = [&](double q) { return absErrors[min(n - 1, static_cast<size_t>(q * (n - 1) + 0.5))]; };
+    s.bias /= n;
+    s.meanAbs /= n;
+    s.p50 = quantile(0.5);
+    s.p95 = quantile(0.95);
+    s.p99 = quantile(0.99);
+    s.max = absErrors.back();
+    s.pairsWithError /= n;
+    s.flipped /= n;
+    return s;
+}
+
+void reportAccuracy(const AccuracyOptions& options, BenchReport& report) {
+    vector<vector<string>> documents = options.corpusDir.empty() ? generateDocuments(options) : loadCorpus(options);
+    vector<pair<size_t, size_t>> pairs;
+    for (size_t i = 0; i < documents.size() && pairs.size() < options.maxPairs; i++)
+        for (size_t j = i + 1; j < documents.size() && pairs.size() < options.maxPairs; j++) pairs.push_back({i, j});
+
+    // Ground truth
+    JaccardOracle oracle;
+    auto start = chrono::steady_clock::now();
+    for (auto& kgrams : documents) oracle.addDocument(kgrams);
+    double oracleBuildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+    vector<double> exact(pairs.size());
+    start = chrono::steady_clock::now();
+    for (size_t p = 0; p < pairs.size(); p++) exact[p] = oracle.similarity(pairs[p].first, pairs[p].second);
+    double oracleNsPerPair = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / max<size_t>(1, pairs.size());
+
+    size_t kgramTotal = 0, similarPairs = 0;
+    for (auto& kgrams : documents) kgramTotal += kgrams.size();
+    for (double j : exact) similarPairs += j >= options.threshold;
+    cout << "[2] ACCURACY vs exact string Jaccard: " << documents.size() << " documents ("
+         << (options.corpusDir.empty() ? "generated" : options.corpusDir) << "), " << kgramTotal / max<size_t>(1, documents.size())
+         << " k-grams each on average, " << pairs.size() << " pairs, " << similarPairs << " at or above " << options.threshold << "\n";
+    cout << "    " << left << setw(24) << "estimator" << right << setw(10) << "bias" << setw(10) << "mean|e|" << setw(10) << "p95|e|"
+         << setw(10) << "p99|e|" << setw(10) << "max|e|" << setw(10) << "pairs e>0" << setw(9) << "flipped"
+         << setw(11) << "false kg" << setw(11) << "build ms" << setw(10) << "ns/pair" << "\n";
+    cout << "    " << left << setw(24) << "exact (oracle)" << right << setw(80) << "" << fixed << setprecision(1)
+         << setw(11) << oracleBuildMs << setw(10) << setprecision(0) << oracleNsPerPair << "\n";
+    report.add("oracle/build", "ms", oracleBuildMs);
+    report.add("oracle/compare", "ns/pair", oracleNsPerPair);
+
+    for (const Estimator& e : estimators()) {
+        vector<double> estimates(pairs.size());
+        double buildMs = 0, nsPerPair = 0;
+        size_t falseShared = 0;
+        if (e.sketchSize == 0) {
+            start = chrono::steady_clock::now();
+            vector<unordered_set<unsigned long>> sets(documents.size());
+            for (size_t d = 0; d < documents.size(); d++)
+                for (auto& kgram : documents[d]) sets[d].insert(static_cast<unsigned long>(e.function->hash(kgram)));
+            buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            start = chrono::steady_clock::now();
+            for (size_t p = 0; p < pairs.size(); p++) estimates[p] = computeJaccard(sets[pairs[p].first], sets[pairs[p].second]);
+            nsPerPair = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / max<size_t>(1, pairs.size());
+
+            // Overlaps that exist only because two different k-grams share a hash (untimed)
+            for (auto& [a, b] : pairs) {
+                size_t shared = 0;
+                for (unsigned long h : sets[a]) shared += sets[b].count(h);
+                size_t real = oracle.intersection(a, b);
+                if (shared > real) falseShared += shared - real;
+            }
+        } else {
+            start = chrono::steady_clock::now();
+            vector<vector<uint64_t>> sketches(documents.size());
+            for (size_t d = 0; d < documents.size(); d++) {
+                vector<uint64_t>& sketch = sketches[d];
+                for (auto& kgram : documents[d]) sketch.push_back(e.function->hash(kgram));
+                sort(sketch.begin(), sketch.end());
+                sketch.erase(unique(sketch.begin(), sketch.end()), sketch.end());
+                if (sketch.size() > e.sketchSize) sketch.resize(e.sketchSize);
+            }
+            buildMs = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+            start = chrono::steady_clock::now();
+            for (size_t p = 0; p < pairs.size(); p++)
+                estimates[p] = sketchJaccard(sketches[pairs[p].first], sketches[pairs[p].second], e.sketchSize);
+            nsPerPair = chrono::duration<double, nano>(chrono::steady_clock::now() - start).count() / max<size_t>(1, pairs.size());
+        }
+
+        ErrorSummary s = summarize(estimates, exact, options.threshold);
+        cout << "    " << left << setw(24) << e.name << right << showpos << scientific << setprecision(1) << setw(10) << s.bias
+             << noshowpos << setw(10) << s.meanAbs << setw(10) << s.p95 << setw(10) << s.p99 << setw(10) << s.max
+             << fixed << setprecision(2) << setw(9) << s.pairsWithError * 100 << "%" << setw(8) << s.flipped * 100 << "%";
+        if (e.sketchSize == 0) cout << setw(11) << falseShared;
+        else cout << setw(11) << "-";
+        cout << setprecision(1) << setw(11) << buildMs << setprecision(0) << setw(10) << nsPerPair << "\n";
+
+        report.add("error/" + e.name + "/mean abs", "jaccard", s.meanAbs);
+        report.add("error/" + e.name + "/p99 abs", "jaccard", s.p99);
+        report.add("error/" + e.name + "/max abs", "jaccard", s.max);
+        report.add("error/" + e.name + "/flipped", "ratio", s.flipped);
+        report.add("time/" + e.name + "/build", "ms", buildMs);
+        report.add("time/" + e.name + "/compare", "ns/pair", nsPerPair);
+    }
+    cout << "\n    e = estimate - exact Jaccard; flipped = verdict at the threshold differs from the oracle's;\n"
+         << "    false kg = shared k-grams that exist only through hash collisions, summed over the pairs\n";
+}
+
+// ================================================
+//  MAIN
+// ================================================
+bool parseArguments(int argc, char* argv[], AccuracyOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        if (arg == "--universe") options.universe = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--docs") options.docs = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--tokens") options.tokens = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--k") options.k = atoi(argv[++i]);
+        else if (arg == "--threshold") options.threshold = atof(argv[++i]);
+        else if (arg == "--max-pairs") options.maxPairs = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "--seed") options.seed = static_cast<unsigned>(atoi(argv[++i]));
+        else if (arg == "--corpus") options.corpusDir = argv[++i];
+        else if (arg == "--json") options.jsonPath = argv[++i];
+        else return false;
+    }
+    return options.k > 0 && options.docs > 1;
+}
+
+int main(int argc, char* argv[]) {
+    AccuracyOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " [--universe N] [--docs N] [--tokens T] [--k K] [--threshold J]\n"
+             << "       [--max-pairs P] [--seed S] [--corpus DIR] [--json FILE]\n";
+        return 1;
+    }
+    BenchReport report("hash_accuracy");
+    reportCollisions(options, report);
+    reportAccuracy(options, report);
+
+    if (!options.jsonPath.empty()) {
+        if (!report.save(options.jsonPath)) {
+            cerr << "Error: cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        cout << "\nResults written to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,56 @@
+/**
+ * Exact Jaccard Oracle — implementation
+ * (see jaccard_oracle.h)
+ */
+
+#include "jaccard_oracle.h"
+
+#include <algorithm>
+#include <set>
+
+using namespace std;
+
+double exactJaccard(const vector<string>& kgramsA, const vector<string>& kgramsB) {
+    set<string> setA(kgramsA.begin(), kgramsA.end());
+    set<string> setB(kgramsB.begin(), kgramsB.end());
+    if (setA.empty() && setB.empty()) return 1.0;
+    int inter = 0;
+    for (const auto& s : setA)
+        if (setB.count(s)) inter++;
+    int uni = (int)setA.size() + (int)setB.size() - inter;
+    return (double)inter / uni;
+}
+
+size_t JaccardOracle::addDocument(const vector<string>& kgrams) {
+    vector<string> distinct = kgrams;
+    sort(distinct.begin(), distinct.end());
+    distinct.erase(unique(distinct.begin(), distinct.end()), distinct.end());
+    documents.push_back(move(distinct));
+    return documents.size() - 1;
+}
+
+size_t JaccardOracle::intersection(size_t a, size_t b) const {
+    const vector<string>& A = documents[a];
+    const vector<string>& B = documents[b];
+    size_t shared = 0;
+    for (size_t i = 0, j = 0; i < A.size() && j < B.size();) {
+        int order = A[i].compare(B[j]);
+        if (order == 0) {
+            shared++;
+            i++;
+            j++;
+        } else if (order < 0) {
+            i++;
+        } else {
+            j++;
+        }
+    }
+    return shared;
+}
+
+// Same convention as computeJaccard(): two empty documents are identical
+double JaccardOracle::similarity(size_t a, size_t b) const {
+    size_t shared = intersection(a, b);
+    size_t unionSize = documents[a].size() + documents[b].size() - shared;
+    return unionSize == 0 ? 1.0 : static_cast<double>(shared) / unionSize;
+}
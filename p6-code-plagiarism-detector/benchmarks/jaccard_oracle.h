@@ -0,0 +1,36 @@
+/**
+ * Exact Jaccard Oracle
+ * ====================
+ *
+ * Ground truth for every hashed or sketched similarity: Jaccard computed on
+ * the k-gram STRINGS themselves, so no hash collision can add or hide an
+ * overlap.
+ *
+ * exactJaccard() is the brute-force baseline of benchmark.cpp (a std::set per
+ * document, built on every call). JaccardOracle keeps each document's distinct
+ * k-grams sorted once, so that many pairs can be checked cheaply.
+ */
+
+#ifndef JACCARD_ORACLE_H
+#define JACCARD_ORACLE_H
+
+#include <string>
+#include <vector>
+
+double exactJaccard(const std::vector<std::string>& kgramsA, const std::vector<std::string>& kgramsB);
+
+class JaccardOracle {
+public:
+    // Returns the document's id (0, 1, 2, ... in the order added)
+    size_t addDocument(const std::vector<std::string>& kgrams);
+
+    size_t documentCount() const { return documents.size(); }
+    size_t distinctKGrams(size_t document) const { return documents[document].size(); }
+    size_t intersection(size_t a, size_t b) const;
+    double similarity(size_t a, size_t b) const;
+
+private:
+    std::vector<std::vector<std::string>> documents; // sorted, distinct
+};
+
+#endif // JACCARD_ORACLE_H
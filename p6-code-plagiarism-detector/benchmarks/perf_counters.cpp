@@ -0,0 +1,157 @@
+/**
+ * Hardware Performance Counters for the Benchmarks — implementation
+ * (see perf_counters.h)
+ */
+
+#include "perf_counters.h"
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+static const char* const EVENT_NAMES[PERF_EVENT_COUNT] = {
+    "cycles", "instructions", "cache-misses", "branch-misses", "dTLB-misses"};
+
+const char* perfEventName(PerfEvent event) {
+    return EVENT_NAMES[event];
+}
+
+bool PerfSample::any() const {
+    for (bool v : valid)
+        if (v) return true;
+    return false;
+}
+
+#if defined(__linux__)
+static void describeEvent(int event, perf_event_attr& attr) {
+    attr.type = PERF_TYPE_HARDWARE;
+    switch (event) {
+    case PERF_CYCLES: attr.config = PERF_COUNT_HW_CPU_CYCLES; break;
+    case PERF_INSTRUCTIONS: attr.config = PERF_COUNT_HW_INSTRUCTIONS; break;
+    case PERF_CACHE_MISSES: attr.config = PERF_COUNT_HW_CACHE_MISSES; break;
+    case PERF_BRANCH_MISSES: attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+    case PERF_DTLB_MISSES:
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        break;
+    }
+}
+
+static string paranoidLevel() {
+    ifstream in("/proc/sys/kernel/perf_event_paranoid");
+    string level;
+    return in >> level ? level : "?";
+}
+
+static string openFailure(int error) {
+    switch (error) {
+    case EACCES:
+    case EPERM: return "not permitted (kernel.perf_event_paranoid = " + paranoidLevel() + ")";
+    case ENOENT:
+    case EOPNOTSUPP:
+    case EINVAL: return "not supported by this CPU or VM";
+    case ENOSYS: return "perf_event_open not available";
+    default: return strerror(error);
+    }
+}
+#endif
+
+PerfCounters::PerfCounters() {
+    for (int& fd : fds) fd = -1;
+#if defined(__linux__)
+    ostringstream missing;
+    for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        describeEvent(event, attr);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // This thread, any CPU, no group
+        fds[event] = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        if (fds[event] < 0) missing << (missing.tellp() > 0 ? "; " : "") << EVENT_NAMES[event] << ": " << openFailure(errno);
+    }
+    statusText = missing.tellp() > 0 ? "unavailable: " + missing.str() : "all events available";
+#else
+    statusText = "hardware counters need Linux perf_event_open";
+#endif
+}
+
+PerfCounters::~PerfCounters() {
+#if defined(__linux__)
+    for (int fd : fds)
+        if (fd >= 0) close(fd);
+#endif
+}
+
+bool PerfCounters::available() const {
+    for (int fd : fds)
+        if (fd >= 0) return true;
+    return false;
+}
+
+void PerfCounters::start() {
+#if defined(__linux__)
+    for (int fd : fds) {
+        if (fd < 0) continue;
+        ioctl(fd, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd, PERF_EVENT_IOC_ENABLE, 0);
+    }
+#endif
+}
+
+PerfSample PerfCounters::stop() {
+    PerfSample sample;
+#if defined(__linux__)
+    for (int fd : fds)
+        if (fd >= 0) ioctl(fd, PERF_EVENT_IOC_DISABLE, 0);
+    for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+        uint64_t values[3]; // value, time enabled, time running
+        if (fds[event] < 0 || read(fds[event], values, sizeof(values)) != sizeof(values) || values[2] == 0) continue;
+        sample.valid[event] = true;
+        sample.count[event] = values[2] < values[1] ? values[0] * (double(values[1]) / values[2]) : values[0];
+    }
+#endif
+    return sample;
+}
+
+// 1234567 -> "1.23M"
+static string shortCount(double value) {
+    static const char* const suffixes[] = {"", "K", "M", "G", "T"};
+    int s = 0;
+    while (value >= 1000 && s < 4) {
+        value /= 1000;
+        s++;
+    }
+    ostringstream out;
+    out << fixed << setprecision(s == 0 ? 0 : 2) << value << suffixes[s];
+    return out.str();
+}
+
+string describePerfSample(const PerfSample& sample, double runs) {
+    if (!sample.any()) return "(counters not available)";
+    ostringstream out;
+    for (int event = 0; event < PERF_EVENT_COUNT; ++event) {
+        if (!sample.valid[event]) continue;
+        if (out.tellp() > 0) out << "  ";
+        out << EVENT_NAMES[event] << " " << shortCount(sample.count[event] / runs);
+        if (event == PERF_INSTRUCTIONS && sample.valid[PERF_CYCLES] && sample.count[PERF_CYCLES] > 0)
+            out << " (IPC " << fixed << setprecision(2) << sample.count[PERF_INSTRUCTIONS] / sample.count[PERF_CYCLES] << ")";
+    }
+    return out.str();
+}
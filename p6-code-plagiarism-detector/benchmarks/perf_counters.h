@@ -0,0 +1,55 @@
+/**
+ * Hardware Performance Counters for the Benchmarks
+ * ================================================
+ *
+ * Counts CPU events of this thread around a stage through Linux
+ * perf_event_open(2): cycles, instructions, cache misses (last level),
+ * branch misses and dTLB load misses, user space only.
+ *
+ * Every event is opened on its own, so one the CPU, the VM or
+ * kernel.perf_event_paranoid does not allow is simply missing from the
+ * samples; status() says which and why. When the kernel multiplexes the
+ * events, the counts are scaled by the time each was actually counting.
+ * On other platforms no event is ever available.
+ */
+
+#ifndef PERF_COUNTERS_H
+#define PERF_COUNTERS_H
+
+#include <string>
+
+enum PerfEvent { PERF_CYCLES, PERF_INSTRUCTIONS, PERF_CACHE_MISSES, PERF_BRANCH_MISSES, PERF_DTLB_MISSES, PERF_EVENT_COUNT };
+
+// "cycles", "instructions", "cache-misses", "branch-misses", "dTLB-misses"
+const char* perfEventName(PerfEvent event);
+
+struct PerfSample {
+    bool valid[PERF_EVENT_COUNT] = {};
+    double count[PERF_EVENT_COUNT] = {};
+
+    bool any() const;
+};
+
+class PerfCounters {
+public:
+    PerfCounters();    // opens every event it may
+    ~PerfCounters();
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool available() const;             // at least one event opened
+    const std::string& status() const { return statusText; }
+
+    void start();                       // zero and enable every event
+    PerfSample stop();                  // disable and read them
+
+private:
+    int fds[PERF_EVENT_COUNT];
+    std::string statusText;
+};
+
+// "cycles 1.23M  instructions 3.40M (IPC 2.76)  cache-misses 1.2K ..." with every
+// count divided by `runs`; "(counters not available)" if nothing was counted
+std::string describePerfSample(const PerfSample& sample, double runs = 1);
+
+#endif // PERF_COUNTERS_H
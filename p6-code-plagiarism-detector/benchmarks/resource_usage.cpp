@@ -0,0 +1,92 @@
+/**
+ * Resource Accounting for the Benchmarks — implementation
+ * (see resource_usage.h)
+ */
+
+#include "resource_usage.h"
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#elif defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+
+#if defined(__linux__)
+// "VmRSS:      5120 kB" -> 5120
+static bool readStatusField(const string& line, const char* field, size_t& valueKB) {
+    size_t length = strlen(field);
+    if (line.compare(0, length, field) != 0 || line.size() <= length || line[length] != ':') return false;
+    valueKB = strtoull(line.c_str() + length + 1, nullptr, 10);
+    return true;
+}
+#endif
+
+ResourceSnapshot sampleResources() {
+    ResourceSnapshot snapshot;
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc))) {
+        snapshot.available = true;
+        snapshot.currentRssKB = pmc.WorkingSetSize / 1024;
+        snapshot.peakRssKB = pmc.PeakWorkingSetSize / 1024;
+        snapshot.minorFaults = pmc.PageFaultCount;
+    }
+#elif defined(__linux__)
+    ifstream status("/proc/self/status");
+    string line;
+    bool haveRss = false, havePeak = false;
+    while (getline(status, line)) {
+        haveRss |= readStatusField(line, "VmRSS", snapshot.currentRssKB);
+        havePeak |= readStatusField(line, "VmHWM", snapshot.peakRssKB);
+    }
+
+    rusage usage{};
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        snapshot.minorFaults = usage.ru_minflt;
+        snapshot.majorFaults = usage.ru_majflt;
+        if (!havePeak) {
+            snapshot.peakRssKB = usage.ru_maxrss; // kilobytes on Linux
+            havePeak = true;
+        }
+    }
+    snapshot.available = haveRss && havePeak;
+#endif
+    return snapshot;
+}
+
+bool resetPeakRss() {
+#if defined(__linux__)
+    // Writing 5 resets VmHWM to the current RSS (Linux 4.0+)
+    FILE* clearRefs = fopen("/proc/self/clear_refs", "w");
+    if (!clearRefs) return false;
+    bool ok = fputs("5", clearRefs) >= 0;
+    ok = fclose(clearRefs) == 0 && ok;
+    return ok;
+#else
+    return false;
+#endif
+}
+
+string describeStageUsage(const StageUsage& usage) {
+    ostringstream out;
+    out << fixed << setprecision(2) << setw(9) << usage.ms << " ms";
+    if (!usage.before.available || !usage.after.available) {
+        out << "  (memory not available)";
+        return out.str();
+    }
+    out << setprecision(1) << "  RSS " << setw(6) << usage.before.currentRssKB / 1024.0 << " -> " << setw(6)
+        << usage.after.currentRssKB / 1024.0 << " MB (peak " << usage.after.peakRssKB / 1024.0 << " MB)"
+        << "  faults +" << usage.after.minorFaults - usage.before.minorFaults << " minor, +"
+        << usage.after.majorFaults - usage.before.majorFaults << " major";
+    return out.str();
+}
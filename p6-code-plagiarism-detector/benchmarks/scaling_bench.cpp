@@ -0,0 +1,409 @@
+/**
+ * Thread and Corpus Scaling Benchmark
+ * ===================================
+ * Runs the detector's four phases on corpora of several sizes with several
+ * thread counts and reports, for every configuration:
+ *
+ *   ingest       read every file                               (parallel over files)
+ *   fingerprint  normalize, tokenize, k-gram and hash each one (parallel over files)
+ *   compare      Jaccard of every pair                         (parallel over rows)
+ *   output       write the compared pairs as CSV               (one thread, as in project6)
+ *
+ * with the throughput in documents/s and pairs/s.
+ *
+ * Every corpus size is run in two variable-numbering modes:
+ *
+ *   shared    one numbering across the whole corpus, as project6 numbers an
+ *             all-pairs run; one thread. normalizeVariables runs one
+ *             regex_replace per variable seen so far, so this grows faster
+ *             than linearly with the corpus and is the real detector's baseline.
+ *   per-file  the numbering restarts for every file, as in query mode, which is
+ *             what lets files be split across threads; one row per thread count,
+ *             with the speedup and parallel efficiency against the smallest
+ *             thread count and the speedup over the shared baseline.
+ *
+ * --shared-max N skips the shared baseline above N documents, where it would
+ * take too long.
+ *
+ * All-pairs comparison grows as n^2, so once a corpus has more than --max-pairs
+ * pairs only the first rows, up to that many pairs, are compared and written;
+ * the table marks those rows "sampled" and pairs/s stays comparable.
+ *
+ * The corpus is generated into a temporary directory, or taken from a
+ * corpus_gen directory with --corpus (its first N files for size N).
+ *
+ * With --timeline FILE every phase, worker thread and per-file task is recorded
+ * as a Chrome trace-event timeline (see common/timeline.h), which shows
+ * stragglers and idle workers that the medians hide.
+ *
+ * Build:  cmake --build build --target scaling_bench
+ * Run:    ./scaling_bench [--sizes N1,N2,...] [--threads T1,T2,...] [--lines L] [--reps R] [--max-pairs P]
+ *                         [--shared-max N] [--corpus DIR] [--csv FILE] [--json FILE] [--timeline FILE]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <cstdio>
+#include <climits>
+#include <atomic>
+#include <thread>
+#include <filesystem>
+#include "pipeline.h"
+#include "result_writer.h"
+#include "bench_report.h"
+#include "timeline.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+struct ScalingOptions {
+    vector<int> sizes = {10, 100, 1000};   // documents
+    vector<int> threads;                   // default 1, 2, 4, ... up to the logical CPUs
+    int lines = 40;                        // lines per generated document
+    int reps = 1;                          // median of this many runs per configuration
+    size_t maxPairs = 5'000'000;
+    int sharedMax = INT_MAX;               // largest corpus given a shared-numbering baseline
+    int k = 3;
+    string corpusDir, csvPath, jsonPath;
+};
+
+struct PhaseTimes {
+    double ingestMs = 0, fingerprintMs = 0, compareMs = 0, outputMs = 0;
+    size_t pairs = 0, totalPairs = 0;
+    double totalMs() const { return ingestMs + fingerprintMs + compareMs + outputMs; }
+};
+
+// ================================================
+//  CORPUS
+// ================================================
+// A small student-style program; the seed varies names and constants
+string generateDocument(int lines, int seed) {
+    ostringstream out;
+    out << "// Document " << seed << "\n#include <iostream>\n#include <vector>\nusing namespace std;\n\n";
+    int written = 5;
+    for (int f = 0; written < lines; ++f) {
+        string a = "n" + to_string((seed + f) % 17), b = "sum" + to_string((seed * 3 + f) % 23);
+        out << "int part" << f << "(int " << a << ") {\n";
+        out << "    int " << b << " = " << (seed + f) % 9 << ";   // accumulator\n";
+        out << "    for (int i = 0; i < " << a << "; i++) {\n";
+        out << "        " << b << " += i * " << (seed + 2 * f) % 13 << ";\n";
+        out << "    }\n";
+        out << "    return " << b << ";\n";
+        out << "}\n\n";
+        written += 8;
+    }
+    out << "int main() {\n    cout << part0(" << seed % 50 << ") << endl;\n    return 0;\n}\n";
+    return out.str();
+}
+
+// Paths of `count` corpus files: from corpusDir/files.txt, or generated under `scratch`
+vector<string> prepareCorpus(const ScalingOptions& options, size_t count, const fs::path& scratch) {
+    vector<string> paths;
+    if (!options.corpusDir.empty()) {
+        ifstream list(fs::path(options.corpusDir) / "files.txt");
+        string line;
+        while (paths.size() < count && getline(list, line)) {
+            if (!line.empty()) paths.push_back((fs::path(options.corpusDir) / line).string());
+        }
+        return paths;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        fs::path dir = scratch / to_string(i / 1000);
+        if (i % 1000 == 0) fs::create_directories(dir);
+        fs::path file = dir / (to_string(i) + ".cpp");
+        ofstream(file) << generateDocument(options.lines, static_cast<int>(i));
+        paths.push_back(file.string());
+    }
+    return paths;
+}
+
+// ================================================
+//  PARALLEL DRIVER
+// ================================================
+// Run body(i) for every i < count on `threads` threads (the caller is one of
+// them), handing out `chunk` indices at a time so uneven items balance out
+template <typename Body>
+void parallelFor(size_t count, int threads, size_t chunk, Body&& body) {
+    atomic<size_t> next{0};
+    auto worker = [&](int id) {
+        if (id > 0) nameTimelineThread("worker " + to_string(id));
+        for (;;) {
+            size_t begin = next.fetch_add(chunk);
+            if (begin >= count) return;
+            size_t end = min(count, begin + chunk);
+            for (size_t i = begin; i < end; ++i) body(i);
+        }
+    };
+    vector<thread> pool;
+    for (int t = 1; t < threads; ++t) pool.emplace_back(worker, t);
+    worker(0);
+    for (auto& t : pool) t.join();
+}
+
+template <typename Phase>
+double timeMs(Phase&& phase) {
+    auto start = chrono::steady_clock::now();
+    phase();
+    return chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+}
+
+// ================================================
+//  ONE CONFIGURATION
+// ================================================
+// With sharedNumbering (one thread only) the variable numbering runs on across
+// the files, as in project6; otherwise it restarts for every file
+PhaseTimes runConfiguration(const vector<string>& paths, int threads, bool sharedNumbering, const ScalingOptions& options,
+                            const fs::path& outputPath) {
+    size_t n = paths.size();
+    PhaseTimes times;
+
+    vector<string> contents(n);
+    times.ingestMs = timeMs([&] {
+        TIMELINE_SCOPE_ARG(TraceCategory::Input, "ingest", "threads", to_string(threads));
+        parallelFor(n, threads, 16, [&](size_t i) { contents[i] = readFile(paths[i]); });
+    });
+
+    vector<unordered_set<unsigned long>> sets(n);
+    times.fingerprintMs = timeMs([&] {
+        TIMELINE_SCOPE_ARG(TraceCategory::Hash, "fingerprint", "threads", to_string(threads));
+        resetVariableMap();
+        parallelFor(n, threads, 1, [&](size_t i) {
+            TIMELINE_SCOPE_ARG(TraceCategory::Hash, "file", "path", paths[i]);
+            if (!sharedNumbering) resetVariableMap();
+            sets[i] = hashKGrams(createKGrams(normalizeAndTokenize(contents[i]), options.k));
+        });
+    });
+
+    // Rows 0..rows-1 in full, as many as fit in maxPairs; rowStart[i] is row i's first slot
+    times.totalPairs = n * (n - 1) / 2;
+    vector<size_t> rowStart = {0};
+    size_t rows = 0;
+    while (rows + 1 < n && rowStart.back() + (n - 1 - rows) <= options.maxPairs) {
+        rowStart.push_back(rowStart.back() + (n - 1 - rows));
+        rows++;
+    }
+    times.pairs = rowStart.back();
+    vector<float> similarity(times.pairs);
+    times.compareMs = timeMs([&] {
+        TIMELINE_SCOPE_ARG(TraceCategory::Similarity, "compare", "threads", to_string(threads));
+        parallelFor(rows, threads, 1, [&](size_t i) {
+            TIMELINE_SCOPE_ARG(TraceCategory::Similarity, "row", "path", paths[i]);
+            float* row = similarity.data() + rowStart[i];
+            for (size_t j = i + 1; j < n; ++j) row[j - i - 1] = static_cast<float>(computeJaccard(sets[i], sets[j]));
+        });
+    });
+
+    times.outputMs = timeMs([&] {
+        TIMELINE_SCOPE(TraceCategory::Similarity, "output");
+        FILE* out = fopen(outputPath.string().c_str(), "wb");
+        if (!out) {
+            cerr << "Error: cannot write " << outputPath.string() << "\n";
+            return;
+        }
+        {
+            ResultWriter writer(out);
+            writer.write("file_a,file_b,similarity\n");
+            for (size_t i = 0; i < rows; ++i) {
+                for (size_t j = i + 1; j < n; ++j) {
+                    writer.write(paths[i]);
+                    writer.write(',');
+                    writer.write(paths[j]);
+                    writer.write(',');
+                    writer.writeNumber(similarity[rowStart[i] + j - i - 1], 4);
+                    writer.write('\n');
+                }
+            }
+        }
+        fclose(out);
+    });
+    return times;
+}
+
+// Per phase, the median over the repetitions
+PhaseTimes medianTimes(vector<PhaseTimes> runs) {
+    auto medianOf = [&](double PhaseTimes::*phase) {
+        vector<double> values;
+        for (auto& r : runs) values.push_back(r.*phase);
+        sort(values.begin(), values.end());
+        return values[values.size() / 2];
+    };
+    PhaseTimes result = runs.front();
+    result.ingestMs = medianOf(&PhaseTimes::ingestMs);
+    result.fingerprintMs = medianOf(&PhaseTimes::fingerprintMs);
+    result.compareMs = medianOf(&PhaseTimes::compareMs);
+    result.outputMs = medianOf(&PhaseTimes::outputMs);
+    return result;
+}
+
+// ================================================
+//  ARGUMENTS
+// ================================================
+bool parseList(const string& text, vector<int>& values) {
+    values.clear();
+    stringstream list(text);
+    string value;
+    while (getline(list, value, ',')) {
+        int v = atoi(value.c_str());
+        if (v <= 0) return false;
+        values.push_back(v);
+    }
+    return !values.empty();
+}
+
+bool parseArguments(int argc, char* argv[], ScalingOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            if (!parseList(argv[++i], options.sizes)) return false;
+        } else if (arg == "--threads" && hasValue) {
+            if (!parseList(argv[++i], options.threads)) return false;
+        } else if (arg == "--lines" && hasValue) {
+            options.lines = atoi(argv[++i]);
+        } else if (arg == "--reps" && hasValue) {
+            options.reps = atoi(argv[++i]);
+        } else if (arg == "--max-pairs" && hasValue) {
+            options.maxPairs = strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--shared-max" && hasValue) {
+            options.sharedMax = atoi(argv[++i]);
+        } else if (arg == "--corpus" && hasValue) {
+            options.corpusDir = argv[++i];
+        } else if (arg == "--csv" && hasValue) {
+            options.csvPath = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--timeline" && hasValue) {
+            if (!startTimeline(argv[++i])) {
+                cerr << "Error: cannot write timeline " << argv[i] << "\n";
+                return false;
+            }
+            nameTimelineThread("main");
+        } else {
+            return false;
+        }
+    }
+    if (options.threads.empty()) {
+        int cpus = max(1u, thread::hardware_concurrency());
+        for (int t = 1; t < cpus; t *= 2) options.threads.push_back(t);
+        options.threads.push_back(cpus);
+    }
+    sort(options.sizes.begin(), options.sizes.end());
+    sort(options.threads.begin(), options.threads.end());
+    return options.lines > 0 && options.reps > 0 && options.maxPairs > 0 && options.sharedMax >= 0;
+}
+
+// ================================================
+//  MAIN — per corpus size, a shared-numbering row and one row per thread count
+// ================================================
+int main(int argc, char* argv[]) {
+    ScalingOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " [--sizes N1,N2,...] [--threads T1,T2,...] [--lines L] [--reps R] [--max-pairs P]\n"
+             << "       [--shared-max N] [--corpus DIR] [--csv FILE] [--json FILE] [--timeline FILE]\n";
+        return 1;
+    }
+
+    fs::path scratch = fs::temp_directory_path() / "p6_scaling_bench";
+    fs::remove_all(scratch);
+    fs::create_directories(scratch);
+    vector<string> corpus = prepareCorpus(options, options.sizes.back(), scratch / "corpus");
+    if (corpus.size() < static_cast<size_t>(options.sizes.back())) {
+        cerr << "Error: the corpus has only " << corpus.size() << " file(s)\n";
+        return 1;
+    }
+    fs::path outputPath = scratch / "pairs.csv";
+
+    cout << "Scaling benchmark (k = " << options.k << ", " << thread::hardware_concurrency() << " logical CPUs, "
+         << (options.corpusDir.empty() ? to_string(options.lines) + "-line generated documents" : "corpus " + options.corpusDir)
+         << ", median of " << options.reps << " run(s))\n\n";
+
+    cout << "numbering: shared   = one variable numbering across the corpus, as project6 runs all pairs (1 thread);\n"
+         << "                       the real detector's baseline\n"
+         << "           per-file = numbering restarted for every file, as in query mode; splits across threads\n"
+         << "speedup and eff are against the fewest per-file threads; vs shared = times faster than the shared row\n\n";
+
+    const char* header = "docs,numbering,threads,ingest_ms,fingerprint_ms,compare_ms,output_ms,total_ms,docs_per_s,pairs_per_s,"
+                         "speedup,efficiency,vs_shared,pairs,sampled";
+    ofstream csv;
+    if (!options.csvPath.empty()) {
+        csv.open(options.csvPath);
+        csv << header << "\n";
+    }
+    cout << right << setw(8) << "docs" << setw(10) << "numbering" << setw(8) << "threads" << setw(11) << "ingest"
+         << setw(13) << "fingerprint" << setw(11) << "compare" << setw(10) << "output" << setw(11) << "total"
+         << setw(11) << "docs/s" << setw(13) << "pairs/s" << setw(9) << "speedup" << setw(6) << "eff" << setw(11)
+         << "vs shared" << "\n";
+    cout << setw(8) << "" << setw(10) << "" << setw(8) << "" << setw(11) << "ms" << setw(13) << "ms" << setw(11) << "ms"
+         << setw(10) << "ms" << setw(11) << "ms" << "\n";
+
+    BenchReport report("scaling_bench");
+    for (int size : options.sizes) {
+        vector<string> paths(corpus.begin(), corpus.begin() + size);
+        bool withShared = size <= options.sharedMax;
+        double sharedMs = 0, baselineMs = 0;
+        int baselineThreads = options.threads.front();
+        // The shared-numbering baseline first, then one per-file row per thread count
+        for (int row = withShared ? -1 : 0; row < static_cast<int>(options.threads.size()); ++row) {
+            bool shared = row < 0;
+            int threads = shared ? 1 : options.threads[row];
+            vector<PhaseTimes> runs;
+            for (int r = 0; r < options.reps; ++r) runs.push_back(runConfiguration(paths, threads, shared, options, outputPath));
+            PhaseTimes t = medianTimes(runs);
+
+            double total = t.totalMs();
+            if (shared) sharedMs = total;
+            else if (threads == baselineThreads) baselineMs = total;
+            double speedup = !shared && total > 0 ? baselineMs / total : 0;
+            double efficiency = speedup * baselineThreads / threads;
+            double vsShared = !shared && withShared && total > 0 ? sharedMs / total : 0;
+            double docsPerSecond = total > 0 ? size / (total / 1000) : 0;
+            double pairsPerSecond = t.compareMs > 0 ? t.pairs / (t.compareMs / 1000) : 0;
+            bool sampled = t.pairs < t.totalPairs;
+            const char* numbering = shared ? "shared" : "per-file";
+
+            cout << fixed << setprecision(1) << setw(8) << size << setw(10) << numbering << setw(8) << threads
+                 << setw(11) << t.ingestMs << setw(13) << t.fingerprintMs << setw(11) << t.compareMs << setw(10)
+                 << t.outputMs << setw(11) << total << setprecision(0) << setw(11) << docsPerSecond << setw(13)
+                 << pairsPerSecond << setprecision(2);
+            if (shared) cout << setw(9) << "-" << setw(6) << "-";
+            else cout << setw(9) << speedup << setw(6) << efficiency;
+            if (vsShared > 0) cout << setw(11) << vsShared;
+            else cout << setw(11) << "-";
+            cout << (sampled ? "  sampled" : "") << "\n";
+            if (csv.is_open()) {
+                csv << size << "," << numbering << "," << threads << "," << t.ingestMs << "," << t.fingerprintMs << ","
+                    << t.compareMs << "," << t.outputMs << "," << total << "," << docsPerSecond << "," << pairsPerSecond
+                    << "," << speedup << "," << efficiency << "," << vsShared << "," << t.pairs << ","
+                    << (sampled ? 1 : 0) << "\n";
+            }
+
+            string name = to_string(size) + " docs/" + (shared ? string("shared numbering") : to_string(threads) + " threads") + "/";
+            vector<double> totals;
+            for (auto& r : runs) totals.push_back(r.totalMs());
+            report.add(name + "total", "ms", totals);
+            report.add(name + "ingest", "ms", t.ingestMs);
+            report.add(name + "fingerprint", "ms", t.fingerprintMs);
+            report.add(name + "compare", "ms", t.compareMs);
+            report.add(name + "output", "ms", t.outputMs);
+            report.add(name + "throughput", "docs/s", docsPerSecond, false);
+        }
+    }
+    fs::remove_all(scratch);
+
+    if (csv.is_open()) cout << "\nTable written to " << options.csvPath << "\n";
+    if (!options.jsonPath.empty()) {
+        if (!report.save(options.jsonPath)) {
+            cerr << "Error: cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        cout << "Results written to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
@@ -0,0 +1,273 @@
+/**
+ * Per-Stage Microbenchmarks
+ * =========================
+ * Times each pipeline stage on its own, on generated C++ sources of several
+ * sizes, against the production implementation (../pipeline.cpp):
+ *   readFile, normalizeSpacesAndLines, removeComments, normalizeVariables,
+ *   tokenize, createKGrams, hashKGrams, computeJaccard
+ *
+ * Each stage's input is produced by the stages before it outside the timed
+ * region. A stage is run once to warm up, then repeated until it has at least
+ * --reps samples and --min-time seconds in total; the report gives the median,
+ * the spread, the fastest sample and the throughput over the input bytes.
+ * --json FILE also writes every row as a metric "stage/lines" in microseconds
+ * (see bench_report.h), for bench_compare. --perf adds a line per row with the
+ * hardware counters of an average run (see perf_counters.h), where permitted;
+ * --alloc one with its heap allocations (see alloc_counter.h), in builds
+ * configured with -DP6_ALLOC_COUNTING=ON.
+ *
+ * Build:  cmake --build build --target bench   (builds and runs this suite)
+ * Run:    ./stage_bench [--sizes L1,L2,...] [--reps N] [--min-time S] [--stage NAME] [--json FILE] [--perf] [--alloc]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <cmath>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include "pipeline.h"
+#include "bench_report.h"
+#include "perf_counters.h"
+#include "alloc_counter.h"
+
+using namespace std;
+namespace fs = std::filesystem;
+
+// Every stage result feeds this, so no stage can be optimized away
+volatile size_t benchmarkSink = 0;
+void consume(size_t value) { benchmarkSink = benchmarkSink + value; }
+
+struct BenchOptions {
+    vector<int> sizes = {100, 1000, 5000}; // lines per generated source
+    int minReps = 10;
+    double minSeconds = 0.5;
+    string stage;                          // empty: every stage
+    string jsonPath;                       // empty: no JSON report
+    PerfCounters* counters = nullptr;      // --perf
+    bool countAllocs = false;              // --alloc
+};
+
+struct Sample {
+    double medianUs = 0, madUs = 0, minUs = 0;
+    int reps = 0;
+    vector<double> samples;                // every timed run, in us
+    PerfSample counters;                   // summed over the timed runs
+    bool countedAllocs = false;
+    AllocStats allocs;                     // summed over the timed runs; peak of any one run
+};
+
+// ================================================
+//  INPUT GENERATOR
+// ================================================
+// A student-style C++ source of about `lines` lines: functions with declarations,
+// loops, comments and blank lines, numbered by `seed` so two sources share structure
+// but not all names
+string generateSource(int lines, int seed) {
+    ostringstream out;
+    out << "// Generated source " << seed << "\n#include <iostream>\n#include <vector>\nusing namespace std;\n\n";
+    int written = 5;
+    for (int f = 0; written < lines; ++f) {
+        string a = "count" + to_string(f % 7), b = "total" + to_string((f + seed) % 11);
+        out << "/* helper " << f << "\n   sums a range */\n";
+        out << "int step" << f << "(int " << a << ", double scale) {\n";
+        out << "    int " << b << " = 0, index = " << f % 5 << ";   // running total\n";
+        out << "    vector<int> values(" << a << ");\n";
+        out << "    for (int i = 0; i < " << a << "; i++) {\n";
+        out << "        values[i] = i * " << (f + seed) % 13 << ";\n";
+        out << "        " << b << " += values[i] + index;\n";
+        out << "\n";
+        out << "    }\n";
+        out << "    if (" << b << " > 100)   " << b << " = " << b << " % 100;\n";
+        out << "    return " << b << " * scale;\n";
+        out << "}\n\n";
+        written += 14;
+    }
+    out << "int main() {\n    cout << step0(10, 1.5) << endl;\n    return 0;\n}\n";
+    return out.str();
+}
+
+// ================================================
+//  MEASUREMENT
+// ================================================
+// Run `body` until both limits are met; `setup` runs before each sample, untimed
+Sample measure(const BenchOptions& options, const function<void()>& setup, const function<void()>& body) {
+    setup();
+    body(); // warm-up
+
+    Sample result;
+    vector<double> samples;
+    double total = 0;
+    while (static_cast<int>(samples.size()) < options.minReps || total < options.minSeconds * 1e6) {
+        setup();
+        if (options.counters) options.counters->start();
+        if (options.countAllocs) startAllocCounting();
+        auto start = chrono::steady_clock::now();
+        body();
+        double us = chrono::duration<double, micro>(chrono::steady_clock::now() - start).count();
+        if (options.countAllocs) {
+            AllocStats run = stopAllocCounting();
+            result.countedAllocs = true;
+            result.allocs.allocations += run.allocations;
+            result.allocs.bytes += run.bytes;
+            result.allocs.peakLiveBytes = max(result.allocs.peakLiveBytes, run.peakLiveBytes);
+        }
+        if (options.counters) {
+            PerfSample run = options.counters->stop();
+            for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+                result.counters.valid[e] = run.valid[e];
+                result.counters.count[e] += run.count[e];
+            }
+        }
+        samples.push_back(us);
+        total += us;
+    }
+
+    result.reps = samples.size();
+    result.samples = samples;
+    sort(samples.begin(), samples.end());
+    result.minUs = samples.front();
+    result.medianUs = samples[samples.size() / 2];
+    vector<double> deviations;
+    for (double us : samples) deviations.push_back(fabs(us - result.medianUs));
+    sort(deviations.begin(), deviations.end());
+    result.madUs = deviations[deviations.size() / 2];
+    return result;
+}
+
+BenchReport report("stage_bench");
+
+void printRow(const string& stage, int lines, size_t bytes, const Sample& s) {
+    report.add(stage + "/" + to_string(lines), "us", s.samples);
+    double mbPerSecond = s.medianUs > 0 ? bytes / s.medianUs : 0; // bytes per us == MB/s
+    cout << "  " << left << setw(24) << stage << right << setw(7) << lines << setw(10) << bytes
+         << fixed << setprecision(1) << setw(13) << s.medianUs << setw(7) << (s.medianUs > 0 ? 100 * s.madUs / s.medianUs : 0) << "%"
+         << setw(13) << s.minUs << setw(10) << setprecision(2) << mbPerSecond << setw(7) << s.reps << "\n";
+    string name = stage + "/" + to_string(lines) + "/";
+    if (s.counters.any()) {
+        cout << "    per run: " << describePerfSample(s.counters, s.reps) << "\n";
+        for (int e = 0; e < PERF_EVENT_COUNT; ++e) {
+            if (s.counters.valid[e]) report.add(name + perfEventName(PerfEvent(e)), "count", s.counters.count[e] / s.reps);
+        }
+    }
+    if (s.countedAllocs) {
+        cout << "    per run: " << describeAllocStats(s.allocs, s.reps) << "\n";
+        report.add(name + "allocations", "count", static_cast<double>(s.allocs.allocations) / s.reps);
+        report.add(name + "allocated bytes", "B", static_cast<double>(s.allocs.bytes) / s.reps);
+        report.add(name + "peak live bytes", "B", static_cast<double>(s.allocs.peakLiveBytes));
+    }
+}
+
+bool parseArguments(int argc, char* argv[], BenchOptions& options, bool& perf) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--sizes" && hasValue) {
+            options.sizes.clear();
+            stringstream list(argv[++i]);
+            string value;
+            while (getline(list, value, ',')) {
+                int lines = atoi(value.c_str());
+                if (lines <= 0) return false;
+                options.sizes.push_back(lines);
+            }
+        } else if (arg == "--reps" && hasValue) {
+            options.minReps = atoi(argv[++i]);
+        } else if (arg == "--min-time" && hasValue) {
+            options.minSeconds = atof(argv[++i]);
+        } else if (arg == "--stage" && hasValue) {
+            options.stage = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            options.jsonPath = argv[++i];
+        } else if (arg == "--perf") {
+            perf = true;
+        } else if (arg == "--alloc") {
+            options.countAllocs = true;
+        } else {
+            return false;
+        }
+    }
+    return !options.sizes.empty() && options.minReps > 0;
+}
+
+// ================================================
+//  MAIN — one row per (stage, size)
+// ================================================
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    bool perf = false;
+    if (!parseArguments(argc, argv, options, perf)) {
+        cerr << "Usage: " << argv[0] << " [--sizes L1,L2,...] [--reps N] [--min-time S] [--stage NAME] [--json FILE] [--perf] [--alloc]\n";
+        return 1;
+    }
+    unique_ptr<PerfCounters> counters;
+    if (perf) {
+        counters = make_unique<PerfCounters>();
+        cout << "Hardware counters: " << counters->status() << "\n";
+        if (counters->available()) options.counters = counters.get();
+    }
+    if (options.countAllocs && !allocCountingAvailable()) {
+        cout << "Allocations: " << describeAllocStats({}) << "\n";
+        options.countAllocs = false;
+    }
+    const int k = 3;
+    auto wanted = [&](const string& stage) { return options.stage.empty() || options.stage == stage; };
+
+    cout << "Per-stage microbenchmarks (k = " << k << ", median of >= " << options.minReps << " runs and >= "
+         << options.minSeconds << " s per row)\n\n";
+    cout << "  " << left << setw(24) << "stage" << right << setw(7) << "lines" << setw(10) << "bytes"
+         << setw(13) << "median us" << setw(8) << "MAD" << setw(13) << "min us" << setw(10) << "MB/s" << setw(7) << "runs" << "\n";
+
+    fs::path scratch = fs::temp_directory_path() / "p6_stage_bench.cpp";
+    for (int lines : options.sizes) {
+        // Inputs of every stage, produced once by the stages before it
+        string source = generateSource(lines, 1);
+        string other = generateSource(lines, 2);
+        ofstream(scratch) << source;
+        resetVariableMap();
+        string spaced = normalizeSpacesAndLines(source);
+        string uncommented = removeComments(spaced);
+        string renamed = normalizeVariables(uncommented);
+        vector<string> tokens = tokenize(renamed);
+        vector<string> kgrams = createKGrams(tokens, k);
+        unordered_set<unsigned long> hashes = hashKGrams(kgrams);
+        unordered_set<unsigned long> otherHashes = hashKGrams(createKGrams(normalizeAndTokenize(other), k));
+        size_t bytes = source.size();
+        auto none = [] {};
+
+        if (wanted("readFile"))
+            printRow("readFile", lines, bytes, measure(options, none, [&] { consume(readFile(scratch.string()).size()); }));
+        if (wanted("normalizeSpacesAndLines"))
+            printRow("normalizeSpacesAndLines", lines, bytes, measure(options, none, [&] { consume(normalizeSpacesAndLines(source).size()); }));
+        if (wanted("removeComments"))
+            printRow("removeComments", lines, bytes, measure(options, none, [&] { consume(removeComments(spaced).size()); }));
+        if (wanted("normalizeVariables"))
+            printRow("normalizeVariables", lines, bytes, measure(options, resetVariableMap, [&] { consume(normalizeVariables(uncommented).size()); }));
+        if (wanted("tokenize"))
+            printRow("tokenize", lines, bytes, measure(options, none, [&] { consume(tokenize(renamed).size()); }));
+        if (wanted("createKGrams"))
+            printRow("createKGrams", lines, bytes, measure(options, none, [&] { consume(createKGrams(tokens, k).size()); }));
+        if (wanted("hashKGrams"))
+            printRow("hashKGrams", lines, bytes, measure(options, none, [&] { consume(hashKGrams(kgrams).size()); }));
+        if (wanted("computeJaccard"))
+            printRow("computeJaccard", lines, bytes, measure(options, none, [&] { consume(computeJaccard(hashes, otherHashes) * 1000); }));
+        cout << "\n";
+    }
+    fs::remove(scratch);
+
+    if (!options.jsonPath.empty()) {
+        if (!report.save(options.jsonPath)) {
+            cerr << "Error: cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        cout << "Results written to " << options.jsonPath << "\n";
+    }
+    return 0;
+}
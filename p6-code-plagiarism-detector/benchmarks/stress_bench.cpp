@@ -0,0 +1,332 @@
+/**
+ * Pathological-Input Stress Benchmark
+ * ===================================
+ * Feeds the pipeline the input shapes its stages handle worst, at growing
+ * sizes, and checks every file against a hard latency budget:
+ *
+ *   long-comment  one block comment       removeComments: std::regex recursion per character
+ *   long-string   one string literal      tokenize: ".*?" recursion per character
+ *   many-locals   thousands of variables  normalizeVariables: one regex_replace over the file per variable
+ *   minified      a program on one line   tokenize: the rest of the input is copied after every token
+ *   space-run     one long run of spaces  normalizeSpacesAndLines: \s+$ retried from every space
+ *
+ * Every case runs the stages in order (normalizeSpacesAndLines, removeComments,
+ * normalizeVariables, tokenize, createKGrams, hashKGrams) and records each
+ * one's time and peak RSS. On POSIX systems each case runs in a child process,
+ * so a stage that overflows the stack or exceeds --timeout-ms is reported as
+ * CRASH or TIMEOUT in that stage instead of ending the run.
+ *
+ * A case fails when the whole pipeline takes longer than --budget-ms for the
+ * file; the exit status is 1 if any case failed.
+ *
+ * Build:  cmake --build build --target stress_bench
+ * Run:    ./stress_bench [--sizes B1,B2,...] [--shape NAME] [--budget-ms MS] [--timeout-ms MS] [--json FILE]
+ */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <unordered_set>
+#include <algorithm>
+#include <iomanip>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include "pipeline.h"
+#include "resource_usage.h"
+#include "bench_report.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <poll.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#define STRESS_ISOLATED 1
+#endif
+
+using namespace std;
+
+const char* const STAGES[] = {"normalizeSpacesAndLines", "removeComments", "normalizeVariables", "tokenize", "createKGrams", "hashKGrams"};
+const int STAGE_COUNT = 6;
+
+struct StressOptions {
+    vector<size_t> sizes = {1024, 4096, 16384, 65536}; // bytes per file
+    string shape;                                      // empty: every shape
+    double budgetMs = 1000;
+    double timeoutMs = 10000;
+    string jsonPath;
+};
+
+struct StageResult {
+    bool done = false;
+    double ms = 0;
+    size_t peakKB = 0;
+};
+
+struct CaseResult {
+    StageResult stages[STAGE_COUNT];
+    int failedStage = -1;   // the stage running when the case crashed or timed out, -1 if none was
+    string failure;         // "", "TIMEOUT" or "CRASH (signal N)"
+    double totalMs() const {
+        double total = 0;
+        for (auto& s : stages) total += s.ms;
+        return total;
+    }
+};
+
+// "in hashKGrams", or where the case died when no stage was running
+string failurePlace(const CaseResult& r) {
+    if (r.failedStage >= 0) return string("in ") + STAGES[r.failedStage];
+    for (int s = STAGE_COUNT - 1; s >= 0; s--)
+        if (r.stages[s].done) return string("after ") + STAGES[s];
+    return "before any stage";
+}
+
+// ================================================
+//  ADVERSARIAL INPUTS — each about `bytes` long
+// ================================================
+string longComment(size_t bytes) {
+    string code = "int main() {\n    /* ";
+    while (code.size() < bytes) code += "this comment never seems to end ";
+    return code + "*/\n    return 0;\n}\n";
+}
+
+string longString(size_t bytes) {
+    string code = "#include <string>\nint main() {\n    std::string text = \"";
+    while (code.size() < bytes) code += "a long literal without any quote ";
+    return code + "\";\n    return text.size();\n}\n";
+}
+
+string manyLocals(size_t bytes) {
+    string code = "int main() {\n";
+    for (int i = 0; code.size() < bytes; i++) code += "    int local" + to_string(i) + " = " + to_string(i) + ";\n";
+    return code + "    return 0;\n}\n";
+}
+
+string minified(size_t bytes) {
+    string code = "#include <iostream>\n";
+    for (int i = 0; code.size() < bytes; i++)
+        code += "int f" + to_string(i) + "(int a){int b=a*2;for(int i=0;i<a;i++){b+=i%7;}return b;}";
+    return code + "int main(){return f0(3);}\n";
+}
+
+string spaceRun(size_t bytes) {
+    return "int main() {\n    int x =" + string(bytes, ' ') + "1;\n    return x;\n}\n";
+}
+
+struct Shape {
+    const char* name;
+    string (*generate)(size_t bytes);
+};
+
+const Shape SHAPES[] = {
+    {"long-comment", longComment}, {"long-string", longString}, {"many-locals", manyLocals},
+    {"minified", minified}, {"space-run", spaceRun},
+};
+
+// ================================================
+//  RUNNING ONE CASE
+// ================================================
+// Run every stage on `code`, calling report(stage, result) when a stage starts
+// (result.done false) and when it ends
+void runStages(const string& code, const function<void(int, const StageResult&)>& report) {
+    resetVariableMap();
+    string text = code;
+    vector<string> tokens, kgrams;
+    unordered_set<unsigned long> hashes;
+    for (int stage = 0; stage < STAGE_COUNT; stage++) {
+        StageResult result;
+        report(stage, result);
+        resetPeakRss();
+        auto start = chrono::steady_clock::now();
+        switch (stage) {
+        case 0: text = normalizeSpacesAndLines(text); break;
+        case 1: text = removeComments(text); break;
+        case 2: text = normalizeVariables(text); break;
+        case 3: tokens = tokenize(text); break;
+        case 4: kgrams = createKGrams(tokens, 3); break;
+        case 5: hashes = hashKGrams(kgrams); break;
+        }
+        result.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        result.peakKB = sampleResources().peakRssKB;
+        result.done = true;
+        report(stage, result);
+    }
+}
+
+#ifdef STRESS_ISOLATED
+// The child reports "begin S" and "end S MS KB" lines through a pipe; whatever
+// it did not finish before dying or timing out is where it failed
+CaseResult runCase(const string& code, const StressOptions& options) {
+    CaseResult result;
+    int channel[2];
+    if (pipe(channel) != 0) {
+        result.failure = "CRASH (no pipe)";
+        return result;
+    }
+    cout.flush();
+    pid_t child = fork();
+    if (child == 0) {
+        close(channel[0]);
+        runStages(code, [&](int stage, const StageResult& r) {
+            string line = r.done ? "end " + to_string(stage) + " " + to_string(r.ms) + " " + to_string(r.peakKB) + "\n"
+                                 : "begin " + to_string(stage) + "\n";
+            if (write(channel[1], line.data(), line.size()) < 0) _exit(2);
+        });
+        _exit(0);
+    }
+    close(channel[1]);
+
+    string received;
+    auto deadline = chrono::steady_clock::now() + chrono::duration<double, milli>(options.timeoutMs);
+    bool timedOut = false;
+    for (;;) {
+        int waitMs = static_cast<int>(chrono::duration<double, milli>(deadline - chrono::steady_clock::now()).count());
+        if (waitMs <= 0) {
+            timedOut = true;
+            break;
+        }
+        pollfd readable = {channel[0], POLLIN, 0};
+        if (poll(&readable, 1, waitMs) <= 0) continue;
+        char buffer[512];
+        ssize_t got = read(channel[0], buffer, sizeof(buffer));
+        if (got <= 0) break; // the child exited or died
+        received.append(buffer, got);
+    }
+    close(channel[0]);
+    if (timedOut) kill(child, SIGKILL);
+    int status = 0;
+    waitpid(child, &status, 0);
+
+    istringstream lines(received);
+    string kind;
+    int stage;
+    while (lines >> kind >> stage) {
+        if (stage < 0 || stage >= STAGE_COUNT) break;
+        if (kind == "begin") {
+            result.failedStage = stage;
+        } else {
+            lines >> result.stages[stage].ms >> result.stages[stage].peakKB;
+            result.stages[stage].done = true;
+            if (result.failedStage == stage) result.failedStage = -1; // not running anything any more
+        }
+    }
+    if (timedOut) {
+        result.failure = "TIMEOUT";
+    } else if (WIFSIGNALED(status)) {
+        result.failure = "CRASH (signal " + to_string(WTERMSIG(status)) + ")";
+    } else if (!WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+        result.failure = "CRASH (exit " + to_string(WEXITSTATUS(status)) + ")";
+    }
+    if (result.failure.empty()) result.failedStage = -1;
+    return result;
+}
+#else
+// No fork(): run in this process, without crash isolation or a timeout
+CaseResult runCase(const string& code, const StressOptions&) {
+    CaseResult result;
+    runStages(code, [&](int stage, const StageResult& r) {
+        if (r.done) result.stages[stage] = r;
+    });
+    return result;
+}
+#endif
+
+// ================================================
+//  MAIN — one row per (shape, size)
+// ================================================
+bool parseArguments(int argc, char* argv[], StressOptions& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            stringstream list(argv[++i]);
+            string value;
+            while (getline(list, value, ',')) {
+                size_t bytes = strtoull(value.c_str(), nullptr, 10);
+                if (bytes == 0) return false;
+                options.sizes.push_back(bytes);
+            }
+        } else if (arg == "--shape") {
+            options.shape = argv[++i];
+        } else if (arg == "--budget-ms") {
+            options.budgetMs = atof(argv[++i]);
+        } else if (arg == "--timeout-ms") {
+            options.timeoutMs = atof(argv[++i]);
+        } else if (arg == "--json") {
+            options.jsonPath = argv[++i];
+        } else {
+            return false;
+        }
+    }
+    return !options.sizes.empty() && options.budgetMs > 0 && options.timeoutMs > 0;
+}
+
+int main(int argc, char* argv[]) {
+    StressOptions options;
+    if (!parseArguments(argc, argv, options)) {
+        cerr << "Usage: " << argv[0] << " [--sizes B1,B2,...] [--shape NAME] [--budget-ms MS] [--timeout-ms MS] [--json FILE]\n";
+        return 1;
+    }
+
+    cout << "Stress benchmark: budget " << options.budgetMs << " ms per file, timeout " << options.timeoutMs << " ms"
+#ifndef STRESS_ISOLATED
+         << " (not enforced: no process isolation on this platform)"
+#endif
+         << "\n\n";
+    const char* columns[] = {"spaces", "comments", "variables", "tokenize", "kgrams", "hash"};
+    cout << "  " << left << setw(14) << "shape" << right << setw(8) << "bytes";
+    for (auto c : columns) cout << setw(11) << c;
+    cout << setw(11) << "total" << setw(10) << "peak MB" << "  verdict\n";
+
+    BenchReport report("stress_bench");
+    int failures = 0;
+    bool shapeFound = false;
+    for (const Shape& shape : SHAPES) {
+        if (!options.shape.empty() && options.shape != shape.name) continue;
+        shapeFound = true;
+        for (size_t size : options.sizes) {
+            string code = shape.generate(size);
+            CaseResult r = runCase(code, options);
+            size_t peakKB = 0;
+
+            cout << "  " << left << setw(14) << shape.name << right << setw(8) << code.size() << fixed << setprecision(1);
+            for (int s = 0; s < STAGE_COUNT; s++) {
+                if (r.stages[s].done) cout << setw(11) << r.stages[s].ms;
+                else cout << setw(11) << (s == r.failedStage ? "!!" : "-");
+                peakKB = max(peakKB, r.stages[s].peakKB);
+            }
+            double total = r.totalMs();
+            bool overBudget = total > options.budgetMs;
+            cout << setw(11) << total << setw(10) << peakKB / 1024.0 << "  ";
+            if (!r.failure.empty()) cout << r.failure << " " << failurePlace(r);
+            else if (overBudget) cout << "OVER BUDGET";
+            else cout << "ok";
+            cout << "\n";
+            if (!r.failure.empty() || overBudget) failures++;
+
+            string name = string(shape.name) + "/" + to_string(size) + "/";
+            if (r.failure.empty()) report.add(name + "total", "ms", total);
+            for (int s = 0; s < STAGE_COUNT; s++)
+                if (r.stages[s].done) report.add(name + STAGES[s], "ms", r.stages[s].ms);
+        }
+    }
+    if (!shapeFound) {
+        cerr << "Unknown shape " << options.shape << "\n";
+        return 1;
+    }
+    report.add("cases over budget or failed", "cases", failures);
+
+    cout << "\n!! = the stage that was running when the case crashed or timed out\n";
+    cout << failures << " case(s) over budget or failed\n";
+    if (!options.jsonPath.empty()) {
+        if (!report.save(options.jsonPath)) {
+            cerr << "Error: cannot write " << options.jsonPath << "\n";
+            return 1;
+        }
+        cout << "Results written to " << options.jsonPath << "\n";
+    }
+    return failures > 0 ? 1 : 0;
+}
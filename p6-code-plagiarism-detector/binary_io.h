@@ -0,0 +1,102 @@
+/**
+ * Binary I/O Helpers
+ * ==================
+ *
+ * Minimal helpers for the on-disk formats (fingerprint cache, index files).
+ * Values are written in native byte order: the files are meant to be reused on
+ * the machine (or cluster) that produced them, not exchanged across platforms.
+ */
+
+#ifndef BINARY_IO_H
+#define BINARY_IO_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+template <typename T>
+void writePod(std::ostream& out, const T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readPod(std::istream& in, T& value) {
+    static_assert(std::is_trivially_copyable_v<T>);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+// Bytes left between the read position and the end of the stream. Counts read
+// from a header are checked against this before anything is allocated for them,
+// so a damaged or truncated file fails to load instead of throwing bad_alloc.
+inline uint64_t remainingBytes(std::istream& in) {
+    std::streampos here = in.tellg();
+    if (here < 0) return 0;
+    in.seekg(0, std::ios::end);
+    std::streampos end = in.tellg();
+    in.seekg(here);
+    return end > here ? static_cast<uint64_t>(end - here) : 0;
+}
+
+// True if `count` records of at least `minBytes` bytes each can still follow
+inline bool countFits(std::istream& in, uint64_t count, uint64_t minBytes) {
+    return count <= remainingBytes(in) / minBytes;
+}
+
+inline void writeString(std::ostream& out, const std::string& s) {
+    writePod(out, static_cast<uint32_t>(s.size()));
+    out.write(s.data(), s.size());
+}
+
+inline bool readString(std::istream& in, std::string& s) {
+    uint32_t length = 0;
+    if (!readPod(in, length)) return false;
+    // Strings are short and many, so rather than seek for the size left, a long
+    // one is read in chunks and fails where the data ends
+    const size_t chunk = 1 << 16;
+    s.clear();
+    while (s.size() < length) {
+        size_t offset = s.size();
+        s.resize(offset + std::min<size_t>(chunk, length - offset));
+        if (!in.read(s.data() + offset, s.size() - offset)) return false;
+    }
+    return true;
+}
+
+template <typename T>
+void writeVector(std::ostream& out, const std::vector<T>& v) {
+    writePod(out, static_cast<uint64_t>(v.size()));
+    out.write(reinterpret_cast<const char*>(v.data()), v.size() * sizeof(T));
+}
+
+template <typename T>
+bool readVector(std::istream& in, std::vector<T>& v) {
+    uint64_t count = 0;
+    if (!readPod(in, count) || !countFits(in, count, sizeof(T))) return false;
+    v.resize(count);
+    return count == 0 || static_cast<bool>(in.read(reinterpret_cast<char*>(v.data()), count * sizeof(T)));
+}
+
+// Write a file so readers only ever see the old or the complete new contents:
+// the data goes to "<path>.tmp" first and is then renamed over the target.
+template <typename WriteBody>
+bool writeFileAtomically(const std::string& path, WriteBody writeBody) {
+    std::string tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::binary | std::ios::trunc);
+        if (!out.is_open()) return false;
+        writeBody(out);
+        out.flush();
+        if (!out) return false;
+    }
+    std::error_code ec;
+    std::filesystem::rename(tmpPath, path, ec);
+    return !ec;
+}
+
+#endif // BINARY_IO_H
@@ -0,0 +1,215 @@
+/**
+ * Checkpoint and Resume for All-Pairs Runs — implementation
+ * (see checkpoint.h for the layout)
+ */
+
+#include "checkpoint.h"
+#include "binary_io.h"
+#include "digest.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+const uint32_t INGEST_MAGIC = 0x47493650; // "P6IG" on little-endian machines
+const uint32_t TILE_MAGIC = 0x4C543650;   // "P6TL" on little-endian machines
+const uint32_t CHECKPOINT_FORMAT_VERSION = 1;
+
+uint64_t runIdentityDigest(const vector<string>& fileNames, uint64_t parametersDigest) {
+    uint64_t digest = parametersDigest;
+    for (const string& fn : fileNames) {
+        error_code ec;
+        uint64_t size = filesystem::file_size(fn, ec);
+        uint64_t modified = ec ? 0 : filesystem::last_write_time(fn, ec).time_since_epoch().count();
+        digest = combineDigest(digest, digestString(fn));
+        digest = combineDigest(digest, combineDigest(size, modified));
+    }
+    return digest;
+}
+
+RunCheckpoint::RunCheckpoint(const string& directory, uint64_t runDigest) : dir(directory), runDigest(runDigest) {
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if (ec) {
+        cerr << "Warning: cannot create checkpoint directory " << dir << ": " << ec.message() << endl;
+    }
+}
+
+void RunCheckpoint::clear() {
+    error_code ec;
+    for (const auto& file : filesystem::directory_iterator(dir, ec)) {
+        if (file.path().extension() == ".ckpt") {
+            filesystem::remove(file.path(), ec);
+        }
+    }
+}
+
+string RunCheckpoint::tilePath(size_t firstRow) const {
+    return dir + "/tile-" + to_string(firstRow) + ".ckpt";
+}
+
+// ---------------------------
+// Ingest state
+// ---------------------------
+
+template <typename Map>
+static void writeDigestMap(ostream& out, const Map& map) {
+    writePod(out, static_cast<uint64_t>(map.size()));
+    for (const auto& [digest, distinct] : map) {
+        writePod(out, digest);
+        writePod(out, static_cast<int32_t>(distinct));
+    }
+}
+
+template <typename Map>
+static bool readDigestMap(istream& in, Map& map) {
+    uint64_t count = 0;
+    if (!readPod(in, count) || !countFits(in, count, sizeof(uint64_t) + sizeof(int32_t))) return false;
+    map.clear();
+    map.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t digest;
+        int32_t distinct;
+        if (!readPod(in, digest) || !readPod(in, distinct)) return false;
+        map[digest] = distinct;
+    }
+    return true;
+}
+
+bool RunCheckpoint::saveIngest(const IngestState& state, const unordered_map<string, string>& variableMap, int varCounter) const {
+    // Variables are stored in numbering order so a restore inserts them as the run did
+    vector<pair<int, const pair<const string, string>*>> variables;
+    for (const auto& entry : variableMap) {
+        variables.push_back({stoi(entry.second.substr(3)), &entry});
+    }
+    sort(variables.begin(), variables.end());
+
+    bool ok = writeFileAtomically(dir + "/ingest.ckpt", [&](ostream& out) {
+        writePod(out, INGEST_MAGIC);
+        writePod(out, CHECKPOINT_FORMAT_VERSION);
+        writePod(out, runDigest);
+        writePod(out, static_cast<uint64_t>(state.nextFile));
+        writePod(out, state.variableMapDigest);
+        writePod(out, static_cast<int32_t>(varCounter));
+
+        writePod(out, static_cast<uint32_t>(state.loadedNames.size()));
+        for (const string& name : state.loadedNames) writeString(out, name);
+        writeVector(out, state.distinctOf);
+
+        writePod(out, static_cast<uint32_t>(state.allHashes.size()));
+        for (size_t d = 0; d < state.allHashes.size(); ++d) {
+            vector<unsigned long> sorted(state.allHashes[d].begin(), state.allHashes[d].end());
+            sort(sorted.begin(), sorted.end());
+            writeString(out, state.distinctNames[d]);
+            writeVector(out, sorted);
+        }
+        writeDigestMap(out, state.distinctByBytes);
+        writeDigestMap(out, state.distinctByTokens);
+
+        writePod(out, static_cast<uint32_t>(variables.size()));
+        for (const auto& [number, entry] : variables) {
+            writeString(out, entry->first);
+            writeString(out, entry->second);
+        }
+    });
+    if (!ok) {
+        cerr << "Warning: cannot write checkpoint in " << dir << endl;
+    }
+    return ok;
+}
+
+bool RunCheckpoint::loadIngest(IngestState& state, unordered_map<string, string>& variableMap, int& varCounter) const {
+    ifstream in(dir + "/ingest.ckpt", ios::binary);
+    uint32_t magic = 0, version = 0;
+    uint64_t digest = 0, nextFile = 0;
+    int32_t counter = 1;
+    if (!readPod(in, magic) || magic != INGEST_MAGIC) return false;
+    if (!readPod(in, version) || version != CHECKPOINT_FORMAT_VERSION) return false;
+    if (!readPod(in, digest) || digest != runDigest) return false;
+
+    IngestState loaded;
+    uint32_t count = 0;
+    if (!readPod(in, nextFile) || !readPod(in, loaded.variableMapDigest) || !readPod(in, counter)) return false;
+    loaded.nextFile = nextFile;
+
+    if (!readPod(in, count) || !countFits(in, count, sizeof(uint32_t))) return false;
+    loaded.loadedNames.resize(count);
+    for (string& name : loaded.loadedNames) {
+        if (!readString(in, name)) return false;
+    }
+    if (!readVector(in, loaded.distinctOf)) return false;
+
+    if (!readPod(in, count) || !countFits(in, count, sizeof(uint32_t) + sizeof(uint64_t))) return false;
+    loaded.distinctNames.resize(count);
+    for (uint32_t d = 0; d < count; ++d) {
+        vector<unsigned long> sorted;
+        if (!readString(in, loaded.distinctNames[d]) || !readVector(in, sorted)) return false;
+        loaded.allHashes.emplace_back(sorted.begin(), sorted.end());
+    }
+    if (!readDigestMap(in, loaded.distinctByBytes) || !readDigestMap(in, loaded.distinctByTokens)) return false;
+
+    unordered_map<string, string> variables;
+    if (!readPod(in, count)) return false;
+    for (uint32_t v = 0; v < count; ++v) {
+        string original, normalized;
+        if (!readString(in, original) || !readString(in, normalized)) return false;
+        variables[original] = normalized;
+    }
+
+    // The ingest loop and the comparison index allHashes with these
+    size_t distinctCount = loaded.allHashes.size();
+    auto inRange = [&](int distinct) { return distinct >= 0 && static_cast<size_t>(distinct) < distinctCount; };
+    if (loaded.distinctOf.size() != loaded.loadedNames.size() || !all_of(loaded.distinctOf.begin(), loaded.distinctOf.end(), inRange)) {
+        return false;
+    }
+    for (const auto* map : {&loaded.distinctByBytes, &loaded.distinctByTokens}) {
+        for (const auto& [digest, distinct] : *map) {
+            if (!inRange(distinct)) return false;
+        }
+    }
+
+    state = move(loaded);
+    variableMap = move(variables);
+    varCounter = counter;
+    return true;
+}
+
+// ---------------------------
+// Similarity tiles
+// ---------------------------
+
+bool RunCheckpoint::saveTile(size_t firstRow, size_t lastRow, size_t n, const vector<double>& cells) const {
+    bool ok = writeFileAtomically(tilePath(firstRow), [&](ostream& out) {
+        writePod(out, TILE_MAGIC);
+        writePod(out, CHECKPOINT_FORMAT_VERSION);
+        writePod(out, runDigest);
+        writePod(out, static_cast<uint64_t>(lastRow));
+        writePod(out, static_cast<uint64_t>(n));
+        out.write(reinterpret_cast<const char*>(cells.data()), cells.size() * sizeof(double));
+    });
+    if (!ok) {
+        cerr << "Warning: cannot write checkpoint tile " << tilePath(firstRow) << endl;
+    }
+    return ok;
+}
+
+bool RunCheckpoint::loadTile(size_t firstRow, size_t lastRow, size_t n, vector<double>& cells) const {
+    ifstream in(tilePath(firstRow), ios::binary);
+    uint32_t magic = 0, version = 0;
+    uint64_t digest = 0, storedLastRow = 0, storedN = 0;
+    if (!readPod(in, magic) || magic != TILE_MAGIC) return false;
+    if (!readPod(in, version) || version != CHECKPOINT_FORMAT_VERSION) return false;
+    if (!readPod(in, digest) || digest != runDigest) return false;
+    if (!readPod(in, storedLastRow) || storedLastRow != lastRow) return false;
+    if (!readPod(in, storedN) || storedN != n) return false;
+
+    // Read into a scratch copy so a truncated tile leaves the cells untouched
+    size_t count = 0;
+    for (size_t i = firstRow; i < lastRow; ++i) count += n - i - 1;
+    vector<double> loaded(count);
+    if (!in.read(reinterpret_cast<char*>(loaded.data()), count * sizeof(double))) return false;
+    cells = move(loaded);
+    return true;
+}
@@ -0,0 +1,66 @@
+/**
+ * Checkpoint and Resume for All-Pairs Runs
+ * ========================================
+ *
+ * A long all-pairs run has two phases, and both are checkpointed into one
+ * directory so an interrupted run can pick up where it stopped (--resume):
+ *
+ *   ingest.ckpt          fingerprint state after the first `nextFile` files:
+ *                        fingerprint sets, duplicate groups and the variable
+ *                        numbering, rewritten periodically during ingest
+ *   tile-<row>.ckpt      one completed tile of the similarity matrix: the
+ *                        upper-triangle cells of a block of rows, written once
+ *
+ * Every file is written to a temporary name and renamed into place, so a
+ * crash mid-write leaves the previous checkpoint intact. Each file carries a
+ * digest of the run's identity (file list, file sizes and modification
+ * times, pipeline parameters); checkpoints of a different run are ignored.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Everything the ingest phase of an all-pairs run has built so far
+struct IngestState {
+    size_t nextFile = 0;                                      // files [0, nextFile) are done
+    std::vector<std::unordered_set<unsigned long>> allHashes; // one set per distinct document
+    std::vector<std::string> distinctNames;                   // first file seen for each set
+    std::vector<int> distinctOf;                              // per loaded file: index into allHashes
+    std::vector<std::string> loadedNames;
+    std::unordered_map<uint64_t, int> distinctByBytes;
+    std::unordered_map<uint64_t, int> distinctByTokens;
+    uint64_t variableMapDigest = 0;
+};
+
+class RunCheckpoint {
+public:
+    RunCheckpoint(const std::string& directory, uint64_t runDigest);
+
+    // Remove every checkpoint file in the directory (fresh start or finished run)
+    void clear();
+
+    bool loadIngest(IngestState& state, std::unordered_map<std::string, std::string>& variableMap, int& varCounter) const;
+    bool saveIngest(const IngestState& state, const std::unordered_map<std::string, std::string>& variableMap, int varCounter) const;
+
+    // Upper-triangle cells (j > i) of rows [firstRow, lastRow) of an n x n matrix,
+    // row after row: n - firstRow - 1 cells of the first row, then one fewer per row
+    bool loadTile(size_t firstRow, size_t lastRow, size_t n, std::vector<double>& cells) const;
+    bool saveTile(size_t firstRow, size_t lastRow, size_t n, const std::vector<double>& cells) const;
+
+private:
+    std::string tilePath(size_t firstRow) const;
+
+    std::string dir;
+    uint64_t runDigest;
+};
+
+// Identity of a run: file list, sizes, modification times and pipeline parameters
+uint64_t runIdentityDigest(const std::vector<std::string>& fileNames, uint64_t parametersDigest);
+
+#endif // CHECKPOINT_H
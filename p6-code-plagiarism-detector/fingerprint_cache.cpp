@@ -0,0 +1,116 @@
+/**
+ * Content-Addressed Fingerprint Cache — implementation
+ * (see fingerprint_cache.h for the keying scheme)
+ */
+
+#include "fingerprint_cache.h"
+#include "binary_io.h"
+#include "digest.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+using namespace std;
+
+const uint32_t ENTRY_MAGIC = 0x50463650; // "P6FP" on little-endian machines
+const uint32_t PAIRS_MAGIC = 0x52503650; // "P6PR" on little-endian machines
+const uint32_t CACHE_FORMAT_VERSION = 2; // 2: entries carry the token-stream digest
+
+FingerprintCache::FingerprintCache(const string& directory) : dir(directory) {
+    error_code ec;
+    filesystem::create_directories(dir, ec);
+    if (ec) {
+        cerr << "Warning: cannot create cache directory " << dir << ": " << ec.message() << endl;
+    }
+
+    // Load the pair table; a missing or damaged table just means a cold cache
+    ifstream in(dir + "/pairs.bin", ios::binary);
+    uint32_t magic = 0, version = 0;
+    uint64_t count = 0;
+    if (!readPod(in, magic) || !readPod(in, version) || !readPod(in, count)) return;
+    if (magic != PAIRS_MAGIC || version != CACHE_FORMAT_VERSION) return;
+    if (!countFits(in, count, sizeof(uint64_t) + sizeof(double))) return;
+    pairSimilarities.reserve(count);
+    for (uint64_t i = 0; i < count; ++i) {
+        uint64_t key;
+        double similarity;
+        if (!readPod(in, key) || !readPod(in, similarity)) break;
+        pairSimilarities[key] = similarity;
+    }
+}
+
+string FingerprintCache::entryPath(uint64_t key) const {
+    return dir + "/" + digestToHex(key) + ".fp";
+}
+
+bool FingerprintCache::lookup(uint64_t key, CacheEntry& entry) {
+    ifstream in(entryPath(key), ios::binary);
+    uint32_t magic = 0, version = 0, varCount = 0;
+    bool ok = in.is_open()
+        && readPod(in, magic) && magic == ENTRY_MAGIC
+        && readPod(in, version) && version == CACHE_FORMAT_VERSION
+        && readVector(in, entry.fingerprints)
+        && readPod(in, varCount)
+        && countFits(in, varCount, 2 * sizeof(uint32_t));
+    if (ok) {
+        entry.newVariables.resize(varCount);
+        for (auto& [original, normalized] : entry.newVariables) {
+            ok = ok && readString(in, original) && readString(in, normalized);
+        }
+        ok = ok && readPod(in, entry.varCounterAfter) && readPod(in, entry.tokensDigest);
+    }
+    if (ok) hitCount++; else missCount++;
+    return ok;
+}
+
+void FingerprintCache::store(uint64_t key, const CacheEntry& entry) {
+    bool ok = writeFileAtomically(entryPath(key), [&](ostream& out) {
+        writePod(out, ENTRY_MAGIC);
+        writePod(out, CACHE_FORMAT_VERSION);
+        writeVector(out, entry.fingerprints);
+        writePod(out, static_cast<uint32_t>(entry.newVariables.size()));
+        for (const auto& [original, normalized] : entry.newVariables) {
+            writeString(out, original);
+            writeString(out, normalized);
+        }
+        writePod(out, entry.varCounterAfter);
+        writePod(out, entry.tokensDigest);
+    });
+    if (!ok) {
+        cerr << "Warning: cannot write cache entry " << entryPath(key) << endl;
+    }
+}
+
+// Pairs are unordered, so the key must not depend on argument order
+uint64_t FingerprintCache::pairKey(uint64_t a, uint64_t b) {
+    if (a > b) swap(a, b);
+    return combineDigest(a, b);
+}
+
+bool FingerprintCache::lookupPair(uint64_t setDigestA, uint64_t setDigestB, double& similarity) const {
+    auto it = pairSimilarities.find(pairKey(setDigestA, setDigestB));
+    if (it == pairSimilarities.end()) return false;
+    similarity = it->second;
+    return true;
+}
+
+void FingerprintCache::storePair(uint64_t setDigestA, uint64_t setDigestB, double similarity) {
+    pairSimilarities[pairKey(setDigestA, setDigestB)] = similarity;
+    pairsDirty = true;
+}
+
+bool FingerprintCache::save() {
+    if (!pairsDirty) return true;
+    bool ok = writeFileAtomically(dir + "/pairs.bin", [&](ostream& out) {
+        writePod(out, PAIRS_MAGIC);
+        writePod(out, CACHE_FORMAT_VERSION);
+        writePod(out, static_cast<uint64_t>(pairSimilarities.size()));
+        for (const auto& [key, similarity] : pairSimilarities) {
+            writePod(out, key);
+            writePod(out, similarity);
+        }
+    });
+    if (ok) pairsDirty = false;
+    else cerr << "Warning: cannot write pair cache in " << dir << endl;
+    return ok;
+}
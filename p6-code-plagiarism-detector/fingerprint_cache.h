@@ -0,0 +1,67 @@
+/**
+ * Content-Addressed Fingerprint Cache
+ * ===================================
+ *
+ * Lets project6 re-run over a corpus without re-tokenizing files it has seen.
+ *
+ * Each file entry is keyed by a digest of:
+ *   - the raw file bytes,
+ *   - the pipeline parameters (k, normalizer version, skip-name list),
+ *   - the variable map as it stood before the file was normalized.
+ * The last part is needed because normalizeVariables() numbers variables across
+ * the whole run, so a file's fingerprints depend on the files processed before
+ * it. A hit replays the variables the file added so later files see the same
+ * map they would have seen without the cache.
+ *
+ * Pair similarities are cached separately, keyed by the digests of the two
+ * fingerprint sets, so only pairs involving a changed file are recomputed.
+ *
+ * Layout of the cache directory:
+ *   <key>.fp    one file per document entry
+ *   pairs.bin   Jaccard values of every pair computed so far
+ */
+
+#ifndef FINGERPRINT_CACHE_H
+#define FINGERPRINT_CACHE_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct CacheEntry {
+    std::vector<unsigned long> fingerprints;                  // sorted k-gram hashes
+    std::vector<std::pair<std::string, std::string>> newVariables; // variableMap additions, in order
+    int varCounterAfter = 1;
+    uint64_t tokensDigest = 0;                                // digest of the normalized token stream
+};
+
+class FingerprintCache {
+public:
+    explicit FingerprintCache(const std::string& directory);
+
+    bool lookup(uint64_t key, CacheEntry& entry);
+    void store(uint64_t key, const CacheEntry& entry);
+
+    bool lookupPair(uint64_t setDigestA, uint64_t setDigestB, double& similarity) const;
+    void storePair(uint64_t setDigestA, uint64_t setDigestB, double similarity);
+
+    // Persist the pair table (document entries are written as they are stored)
+    bool save();
+
+    int hits() const { return hitCount; }
+    int misses() const { return missCount; }
+
+private:
+    static uint64_t pairKey(uint64_t a, uint64_t b);
+    std::string entryPath(uint64_t key) const;
+
+    std::string dir;
+    std::unordered_map<uint64_t, double> pairSimilarities;
+    bool pairsDirty = false;
+    int hitCount = 0;
+    int missCount = 0;
+};
+
+#endif // FINGERPRINT_CACHE_H
@@ -0,0 +1,129 @@
+/**
+ * Persisted Fingerprint Index — implementation
+ * (see fingerprint_index.h for the layout)
+ */
+
+#include "fingerprint_index.h"
+#include "binary_io.h"
+
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <unordered_map>
+#include <utility>
+using namespace std;
+
+const uint32_t INDEX_MAGIC = 0x58493650; // "P6IX" on little-endian machines
+const uint32_t INDEX_FORMAT_VERSION = 1;
+
+bool FingerprintIndex::load(const string& path) {
+    ifstream in(path, ios::binary);
+    uint32_t magic = 0, version = 0, documentCount = 0;
+    if (!readPod(in, magic) || magic != INDEX_MAGIC) return false;
+    if (!readPod(in, version) || version != INDEX_FORMAT_VERSION) return false;
+    if (!readPod(in, k) || !readPod(in, parametersDigest) || !readPod(in, documentCount)) return false;
+    if (!countFits(in, documentCount, sizeof(uint32_t))) return false;
+
+    documentNames.resize(documentCount);
+    for (string& name : documentNames) {
+        if (!readString(in, name)) return false;
+    }
+    if (!readVector(in, documentSizes) || !readVector(in, fingerprints) || !readVector(in, offsets) ||
+        !readVector(in, postings)) {
+        return false;
+    }
+
+    // query() indexes postings and documentSizes with these without further checks
+    if (documentSizes.size() != documentCount || offsets.size() != fingerprints.size() + 1) return false;
+    if (offsets.front() != 0 || offsets.back() != postings.size()) return false;
+    if (adjacent_find(offsets.begin(), offsets.end(), greater<uint64_t>()) != offsets.end()) return false;
+    if (adjacent_find(fingerprints.begin(), fingerprints.end(), greater_equal<unsigned long>()) != fingerprints.end()) return false;
+    return all_of(postings.begin(), postings.end(), [&](uint32_t id) { return id < documentCount; });
+}
+
+bool FingerprintIndex::save(const string& path) const {
+    return writeFileAtomically(path, [&](ostream& out) {
+        writePod(out, INDEX_MAGIC);
+        writePod(out, INDEX_FORMAT_VERSION);
+        writePod(out, k);
+        writePod(out, parametersDigest);
+        writePod(out, static_cast<uint32_t>(documentNames.size()));
+        for (const string& name : documentNames) {
+            writeString(out, name);
+        }
+        writeVector(out, documentSizes);
+        writeVector(out, fingerprints);
+        writeVector(out, offsets);
+        writeVector(out, postings);
+    });
+}
+
+void FingerprintIndex::addDocuments(const vector<string>& names, const vector<unordered_set<unsigned long>>& fingerprintSets) {
+    // Flatten the existing postings back into (fingerprint, document) pairs
+    vector<pair<unsigned long, uint32_t>> entries;
+    entries.reserve(postings.size());
+    for (size_t i = 0; i < fingerprints.size(); ++i) {
+        for (uint64_t p = offsets[i]; p < offsets[i + 1]; ++p) {
+            entries.push_back({fingerprints[i], postings[p]});
+        }
+    }
+
+    for (size_t d = 0; d < names.size(); ++d) {
+        uint32_t id = static_cast<uint32_t>(documentNames.size());
+        documentNames.push_back(names[d]);
+        documentSizes.push_back(static_cast<uint32_t>(fingerprintSets[d].size()));
+        for (unsigned long fp : fingerprintSets[d]) {
+            entries.push_back({fp, id});
+        }
+    }
+    sort(entries.begin(), entries.end());
+
+    // Rebuild the CSR arrays
+    fingerprints.clear();
+    offsets.clear();
+    postings.clear();
+    postings.reserve(entries.size());
+    for (const auto& [fp, id] : entries) {
+        if (fingerprints.empty() || fingerprints.back() != fp) {
+            fingerprints.push_back(fp);
+            offsets.push_back(postings.size());
+        }
+        postings.push_back(id);
+    }
+    offsets.push_back(postings.size());
+}
+
+vector<IndexMatch> FingerprintIndex::query(const unordered_set<unsigned long>& queryFingerprints, double threshold, int topK) const {
+    // Count shared fingerprints per archived document, touching only the relevant posting
+    // lists; the counts are keyed by document id, so nothing is sized by the archive
+    unordered_map<uint32_t, uint32_t> shared;
+    for (unsigned long fp : queryFingerprints) {
+        auto it = lower_bound(fingerprints.begin(), fingerprints.end(), fp);
+        if (it == fingerprints.end() || *it != fp) continue;
+        size_t i = it - fingerprints.begin();
+        for (uint64_t p = offsets[i]; p < offsets[i + 1]; ++p) {
+            shared[postings[p]]++;
+        }
+    }
+
+    // J(A,B) = |A∩B| / (|A| + |B| - |A∩B|)
+    vector<IndexMatch> matches;
+    for (const auto& [id, count] : shared) {
+        double unionSize = queryFingerprints.size() + documentSizes[id] - count;
+        double similarity = count / unionSize;
+        if (similarity >= threshold) {
+            matches.push_back({id, similarity});
+        }
+    }
+
+    auto better = [](const IndexMatch& a, const IndexMatch& b) {
+        return a.similarity != b.similarity ? a.similarity > b.similarity : a.documentId < b.documentId;
+    };
+    if (topK > 0 && matches.size() > static_cast<size_t>(topK)) {
+        partial_sort(matches.begin(), matches.begin() + topK, matches.end(), better);
+        matches.resize(topK);
+    } else {
+        sort(matches.begin(), matches.end(), better);
+    }
+    return matches;
+}
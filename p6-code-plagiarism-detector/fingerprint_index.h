@@ -0,0 +1,60 @@
+/**
+ * Persisted Fingerprint Index
+ * ===========================
+ *
+ * An inverted index from k-gram fingerprint to the archived documents that
+ * contain it. New submissions are checked against the archive by walking only
+ * the posting lists of their own fingerprints, so a query costs
+ * O(|query fingerprints| + total posting-list length) instead of comparing
+ * against every archived document.
+ *
+ * Postings are kept in a flat, sorted (CSR-style) layout:
+ *   fingerprints[i]                         i-th distinct fingerprint, ascending
+ *   postings[offsets[i] .. offsets[i + 1])  ids of the documents containing it
+ * which loads with three bulk reads and needs no per-entry allocation.
+ */
+
+#ifndef FINGERPRINT_INDEX_H
+#define FINGERPRINT_INDEX_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+struct IndexMatch {
+    uint32_t documentId;
+    double similarity;
+};
+
+class FingerprintIndex {
+public:
+    FingerprintIndex(int k = 3, uint64_t parametersDigest = 0) : k(k), parametersDigest(parametersDigest) {}
+
+    bool load(const std::string& path);
+    bool save(const std::string& path) const;
+
+    // Add a batch of documents and rebuild the posting lists once
+    void addDocuments(const std::vector<std::string>& names,
+                      const std::vector<std::unordered_set<unsigned long>>& fingerprintSets);
+
+    // Archived documents with Jaccard >= threshold, best first; topK > 0 keeps only the first topK
+    std::vector<IndexMatch> query(const std::unordered_set<unsigned long>& fingerprints,
+                                  double threshold, int topK) const;
+
+    int kValue() const { return k; }
+    uint64_t parameters() const { return parametersDigest; }
+    size_t documentCount() const { return documentNames.size(); }
+    const std::string& documentName(uint32_t id) const { return documentNames[id]; }
+
+private:
+    int k;
+    uint64_t parametersDigest;
+    std::vector<std::string> documentNames;
+    std::vector<uint32_t> documentSizes;   // |fingerprint set| per document
+    std::vector<unsigned long> fingerprints;
+    std::vector<uint64_t> offsets;         // fingerprints.size() + 1 entries
+    std::vector<uint32_t> postings;
+};
+
+#endif // FINGERPRINT_INDEX_H
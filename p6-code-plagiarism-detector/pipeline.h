@@ -0,0 +1,58 @@
+/**
+ * Fingerprinting Pipeline
+ * =======================
+ *
+ * The per-file stages of project6, in the order they run:
+ *   readFile -> normalizeSpacesAndLines -> removeComments -> normalizeVariables
+ *            -> tokenize -> createKGrams -> hashKGrams
+ * and computeJaccard to compare two fingerprint sets.
+ *
+ * They live in their own translation unit so that the detector and the
+ * benchmarks (benchmarks/) run the same code.
+ *
+ * normalizeVariables() numbers variables across every file it sees in a run,
+ * through variableMap and varCounter; resetVariableMap() starts the numbering
+ * over. The numbering is per thread, so threads that each reset it before a
+ * file can fingerprint files independently in parallel.
+ */
+
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// Bump whenever a normalization step changes its output, so cached fingerprints
+// produced by an older pipeline are never reused
+const int NORMALIZER_VERSION = 1;
+
+std::string readFile(const std::string& filename);
+
+std::string normalizeSpacesAndLines(const std::string& code);
+std::string removeComments(const std::string& code);
+
+// Variable numbering shared by every file of a run (one per thread)
+extern thread_local std::unordered_map<std::string, std::string> variableMap;
+extern thread_local int varCounter;
+extern const std::unordered_set<std::string> skipNames; // never renamed
+
+std::string normalizeVariables(std::string code);
+void resetVariableMap();
+
+std::vector<std::string> tokenize(const std::string& code);
+
+// Run the normalization steps and tokenize (everything before k-gram hashing)
+std::vector<std::string> normalizeAndTokenize(const std::string& code);
+
+// Tokens separated by spaces, for trace output
+std::string joinTokens(const std::vector<std::string>& tokens);
+
+std::vector<std::string> createKGrams(const std::vector<std::string>& tokens, int k);
+unsigned long simpleHash(const std::string& s);
+std::unordered_set<unsigned long> hashKGrams(const std::vector<std::string>& kgrams);
+
+double computeJaccard(const std::unordered_set<unsigned long>& A, const std::unordered_set<unsigned long>& B);
+
+#endif // PIPELINE_H
@@ -33,214 +33,243 @@
 #include <vector>
 #include <unordered_set>
 #include <unordered_map>
-#include <regex>
 #include <algorithm>
 #include <iomanip>  // for setprecision
+#include <memory>
+#include <chrono>
+#include <charconv>
+#include <cstring>
+#include "checkpoint.h"
+#include "digest.h"
+#include "fingerprint_cache.h"
+#include "fingerprint_index.h"
+#include "pipeline.h"
+#include "result_writer.h"
+#include "timeline.h"
+#include "trace.h"
 using namespace std;
 
 // ---------------------------
-// Step 1: Helper Functions for Code Normalization
+// Step 1: Normalization, Tokenizing and Hashing (pipeline.cpp)
 // ---------------------------
 
-// Read file content into a string
-string readFile(const string& filename) {
-    ifstream file(filename);
-    if (!file.is_open()) {
-        cerr << "Error opening file: " << filename << endl;
-        return "";
+// Produce the pairwise similarity matrix one file row at a time, so it can be
+// streamed to the output without ever holding all n x n cells.
+//
+// Only distinct documents are compared, and only in the upper triangle, in tiles
+// of rows: row r of a tile holds J(r, s) for every s > r. Files are numbered in
+// the order their documents first appear, so a file's row only needs the tile of
+// its own document, except for documents that several files share: their full
+// rows are kept, filled in from every tile as it goes by. The matrix format also
+// prints the cells left of the diagonal, so for it the whole upper triangle over
+// distinct documents is kept instead.
+//
+// With a cache, pairs whose two fingerprint sets were already compared in an
+// earlier run are looked up instead. With a checkpoint, finished tiles are saved
+// as they complete and tiles saved by an interrupted run are loaded, not recomputed.
+const size_t CHECKPOINT_TILE_ROWS = 64;
+class SimilarityRows {
+public:
+    SimilarityRows(const vector<unordered_set<unsigned long>>& allHashes, const vector<int>& distinctOf, bool fullRows,
+                   FingerprintCache* cache = nullptr, const RunCheckpoint* checkpoint = nullptr)
+        : allHashes(allHashes), distinctOf(distinctOf), fullRows(fullRows), cache(cache), checkpoint(checkpoint),
+          row(distinctOf.size(), 1.0) {
+        size_t m = allHashes.size();
+        if (cache) {
+            for (const auto& hashes : allHashes) {
+                vector<unsigned long> sorted(hashes.begin(), hashes.end());
+                sort(sorted.begin(), sorted.end());
+                setDigests.push_back(digestFingerprints(sorted));
+            }
+        }
+        if (fullRows) {
+            triangle.resize(m * (m - (m > 0)) / 2);
+        } else {
+            vector<int> files(m, 0);
+            for (int d : distinctOf) files[d]++;
+            sharedRow.assign(m, -1);
+            for (size_t d = 0; d < m; ++d) {
+                if (files[d] < 2) continue;
+                sharedRow[d] = static_cast<int>(sharedRows.size());
+                sharedRows.emplace_back(m, 1.0);
+            }
+        }
     }
-    stringstream buffer;
-    buffer << file.rdbuf();
-    file.close();
-    return buffer.str();
-}
 
-// Normalize spaces and empty lines in code
-string normalizeSpacesAndLines(const string& code) {
-    stringstream ss(code);
-    string line, result;
-    while (getline(ss, line)) {
-        // Remove leading/trailing whitespace
-        line = regex_replace(line, regex("^\\s+|\\s+$"), "");
-        // Collapse multiple spaces/tabs into one space
-        line = regex_replace(line, regex("[ \t]+"), " ");
-        if (!line.empty()) {
-            result += line + "\n";
+    // Row i over files: cells j > i, and every cell if fullRows
+    const vector<double>& fileRow(size_t i) {
+        size_t d = distinctOf[i];
+        while (d >= tileEnd) computeNextTile();
+        for (size_t j = fullRows ? 0 : i + 1; j < distinctOf.size(); ++j) {
+            row[j] = similarity(d, distinctOf[j]);
         }
+        return row;
     }
-    return result;
-}
 
-// Remove C++ comments (both single-line and multi-line)
-string removeComments(const string& code) {
-    // First remove multi-line comments
-    regex multiLineComments(R"(/\*[\s\S]*?\*/)"/*, regex::dotall*/);
-    string withoutMultiLine = regex_replace(code, multiLineComments, "");
+private:
+    // J(d, e) for a pair that is already computed (see fileRow)
+    double similarity(size_t d, size_t e) const {
+        if (d == e) return 1.0;
+        if (fullRows) return triangle[triangleIndex(min(d, e), max(d, e))];
+        if (sharedRow[d] >= 0) return sharedRows[sharedRow[d]][e];
+        if (sharedRow[e] >= 0) return sharedRows[sharedRow[e]][d];
+        return tileCells[tileOffset(d) + (e - d - 1)]; // e > d and row d is in the current tile
+    }
 
-    // Then remove single-line comments
-    regex singleLineComments(R"(//[^\n]*)");
-    string withoutComments = regex_replace(withoutMultiLine, singleLineComments, "");
+    size_t triangleIndex(size_t d, size_t e) const {
+        size_t m = allHashes.size();
+        return d * (2 * m - d - 1) / 2 + (e - d - 1);
+    }
 
-    return withoutComments;
-}
+    // Where row d's cells start in tileCells
+    size_t tileOffset(size_t d) const {
+        size_t m = allHashes.size();
+        return (d - tileStart) * (2 * m - tileStart - d - 1) / 2;
+    }
 
-// Normalize variable names to standardized format (var1, var2, etc.)
-unordered_map<string, string> variableMap;
-int varCounter = 1;
-string normalizeVariables(string code) {
-    unordered_set<string> skipNames = {"main", "cout", "cin", "endl", "vector", "string", "bool", "char", "int", "float", "double", "return", "for", "if", "while"};
-
-    // Find variable declarations
-    regex declLinePattern(R"(\b(int|float|double|char|string|bool|vector|auto|size_t)\b\s+([^;=\)]+)[;=\)])");
-    smatch match;
-    string::const_iterator searchStart(code.cbegin());
-
-    while (regex_search(searchStart, code.cend(), match, declLinePattern)) {
-        //string type = match[1]; // int, float, etc.
-        string varList = match[2]; // variable name or list of variables
-
-        // Handle multiple variables in one declaration
-        stringstream ss(varList);
-        string token;
-        while (getline(ss, token, ',')) {
-            // Clean up whitespace and remove array brackets
-            token = regex_replace(token, regex(R"(\[.*\])"), ""); // remove array specs
-            token = regex_replace(token, regex(R"(^\s+|\s+$)"), ""); // trim
-
-            // Extract just the variable name (no initializers)
-            smatch varMatch;
-            regex varNamePattern(R"(([a-zA-Z_][a-zA-Z0-9_]*))");
-            if (regex_search(token, varMatch, varNamePattern)) {
-                string varName = varMatch[1];
-                if (!varName.empty() && skipNames.find(varName) == skipNames.end() && variableMap.find(varName) == variableMap.end()) {
-                    variableMap[varName] = "var" + to_string(varCounter++);
+    void computeNextTile() {
+        size_t m = allHashes.size();
+        tileStart = tileEnd;
+        tileEnd = min(m, tileStart + CHECKPOINT_TILE_ROWS);
+        if (!checkpoint || !checkpoint->loadTile(tileStart, tileEnd, m, tileCells)) {
+            tileCells.clear();
+            for (size_t d = tileStart; d < tileEnd; ++d) {
+                for (size_t e = d + 1; e < m; ++e) {
+                    double value;
+                    if (!cache || !cache->lookupPair(setDigests[d], setDigests[e], value)) {
+                        value = computeJaccard(allHashes[d], allHashes[e]);
+                        if (cache) cache->storePair(setDigests[d], setDigests[e], value);
+                    }
+                    tileCells.push_back(value);
                 }
             }
+            if (checkpoint) checkpoint->saveTile(tileStart, tileEnd, m, tileCells);
         }
 
-        searchStart = match.suffix().first;
-    }
-
-    // // Also catch for-loop variables
-    // regex forLoopPattern(R"(\bfor\s*\(\s*(int|float|double|char|size_t)\s+([a-zA-Z_][a-zA-Z0-9_]*)\s*)");
-    // searchStart = code.cbegin();
-    // while (regex_search(searchStart, code.cend(), match, forLoopPattern)) {
-    //     string varName = match[2];
-    //     if (!varName.empty() && skipNames.find(varName) == skipNames.end() && variableMap.find(varName) == variableMap.end()) {
-    //         variableMap[varName] = "var" + to_string(varCounter++);
-    //     }
-    //     searchStart = match.suffix().first;
-    // }
-
-    // Replace all variable names in code
-    for (const auto& [original, normalized] : variableMap) {
-        code = regex_replace(code, regex("\\b" + original + "\\b"), normalized);
+        const double* cell = tileCells.data();
+        for (size_t d = tileStart; d < tileEnd; ++d) {
+            for (size_t e = d + 1; e < m; ++e, ++cell) {
+                if (fullRows) {
+                    triangle[triangleIndex(d, e)] = *cell;
+                    continue;
+                }
+                if (sharedRow[d] >= 0) sharedRows[sharedRow[d]][e] = *cell;
+                if (sharedRow[e] >= 0) sharedRows[sharedRow[e]][d] = *cell;
+            }
+        }
     }
 
-    return code;
-}
+    const vector<unordered_set<unsigned long>>& allHashes;
+    const vector<int>& distinctOf;
+    bool fullRows;
+    FingerprintCache* cache;
+    const RunCheckpoint* checkpoint;
+    vector<uint64_t> setDigests;
 
-// Tokenize code into meaningful units
-vector<string> tokenize(const string& code) {
-    vector<string> tokens;
-    // Match string literals, identifiers, numbers, operators, and symbols
-    regex pattern(R"((\".*?\")|([a-zA-Z_][a-zA-Z0-9_]*)|(\d+(\.\d+)?)|(\+\+|--|==|!=|<=|>=)|([=+\-*/%<>&|^!;:.,()[\]{}]))");
-
-    smatch match;
-    string input = code;
-    while (regex_search(input, match, pattern)) {
-        tokens.push_back(match.str(0));
-        input = match.suffix().str();
-    }
+    size_t tileStart = 0, tileEnd = 0;
+    vector<double> tileCells;          // upper-triangle cells of rows [tileStart, tileEnd)
+    vector<double> triangle;           // fullRows: every upper-triangle cell
+    vector<int> sharedRow;             // per document: index into sharedRows, or -1
+    vector<vector<double>> sharedRows; // full rows of documents shared by several files
+    vector<double> row;
+};
 
-    return tokens;
-}
 
-// Create k-grams from tokens
-vector<string> createKGrams(const vector<string>& tokens, int k) {
-    vector<string> kgrams;
+// ---------------------------
+// Step 2: Incremental Re-runs
+// ---------------------------
 
-    if (tokens.size() < k) {
-        return kgrams; // Not enough tokens to form k-grams
+// Digest of everything besides the file bytes that affects a file's fingerprints
+uint64_t pipelineParametersDigest(int k) {
+    vector<string> names(skipNames.begin(), skipNames.end());
+    sort(names.begin(), names.end());
+    uint64_t digest = combineDigest(NORMALIZER_VERSION, k);
+    for (const string& name : names) {
+        digest = combineDigest(digest, digestString(name));
     }
+    return digest;
+}
 
-    for (size_t i = 0; i <= tokens.size() - k; ++i) {
-        stringstream kgram;
-        for (int j = 0; j < k; ++j) {
-            kgram << tokens[i + j];
-            if (j < k - 1) {
-                kgram << " ";
-            }
+// Variables added to variableMap since varCounter was `counterBefore`, in numbering order
+vector<pair<string, string>> variablesAddedSince(int counterBefore) {
+    vector<pair<int, pair<string, string>>> added;
+    for (const auto& [original, normalized] : variableMap) {
+        int number = stoi(normalized.substr(3)); // "varN"
+        if (number >= counterBefore) {
+            added.push_back({number, {original, normalized}});
         }
-        kgrams.push_back(kgram.str());
     }
+    sort(added.begin(), added.end());
 
-    return kgrams;
-}
-
-// Simple polynomial rolling hash function
-unsigned long simpleHash(const string& s) {
-    const int base = 257;
-    const int mod = 1000000007;
-    unsigned long hash = 0;
-    for (char c : s) {
-        hash = (hash * base + c) % mod;
+    vector<pair<string, string>> result;
+    for (auto& [number, entry] : added) {
+        result.push_back(move(entry));
     }
-    return hash;
+    return result;
 }
 
-// Hash all k-grams and store in unordered_set
-unordered_set<unsigned long> hashKGrams(const vector<string>& kgrams) {
-    unordered_set<unsigned long> hashSet;
 
-    for (const string& kgram : kgrams) {
-        // Print each k-gram before hashing as specified in the requirements
-        //cout << "K-gram: " << kgram << endl;
-        unsigned long hash = simpleHash(kgram);
-        hashSet.insert(hash);
-    }
+// ---------------------------
+// Step 3: Archive Index and Query Mode
+// ---------------------------
 
-    return hashSet;
+// Fingerprint files independently of each other: variable numbering restarts for
+// every file, so an archived document's fingerprints never depend on what was
+// indexed before it and a query file normalizes the same way it would have in the archive
+vector<unordered_set<unsigned long>> fingerprintFilesIndependently(const vector<string>& fileNames, int k) {
+    vector<unordered_set<unsigned long>> sets;
+    for (const string& fn : fileNames) {
+        TIMELINE_SCOPE_ARG(TraceCategory::Input, "file", "path", fn);
+        resetVariableMap();
+        sets.push_back(hashKGrams(createKGrams(normalizeAndTokenize(readFile(fn)), k)));
+    }
+    resetVariableMap();
+    return sets;
 }
 
-// Compute Jaccard similarity between two sets
-double computeJaccard(const unordered_set<unsigned long>& A, const unordered_set<unsigned long>& B) {
-    if (A.empty() && B.empty()) {
-        return 1.0; // Both empty sets are considered identical
+// Add files to an index (creating it if missing)
+int runBuildIndex(const string& indexPath, const vector<string>& fileNames, int k) {
+    FingerprintIndex index(k, pipelineParametersDigest(k));
+    if (ifstream(indexPath).good() && !index.load(indexPath)) {
+        cerr << "Error: " << indexPath << " is not a readable fingerprint index" << endl;
+        return 1;
     }
-
-    // Calculate intersection size
-    int intersectionSize = 0;
-    for (const auto& hashVal : A) {
-        if (B.find(hashVal) != B.end()) {
-            intersectionSize++;
-        }
+    if (index.parameters() != pipelineParametersDigest(index.kValue())) {
+        cerr << "Error: " << indexPath << " was built by a different pipeline version" << endl;
+        return 1;
     }
 
-    // Calculate union size: A.size() + B.size() - intersection size
-    int unionSize = A.size() + B.size() - intersectionSize;
-
-    return static_cast<double>(intersectionSize) / unionSize;
+    index.addDocuments(fileNames, fingerprintFilesIndependently(fileNames, index.kValue()));
+    if (!index.save(indexPath)) {
+        cerr << "Error: cannot write " << indexPath << endl;
+        return 1;
+    }
+    cout << "Indexed " << fileNames.size() << " file(s); " << indexPath << " now holds "
+         << index.documentCount() << " document(s) (k=" << index.kValue() << ")" << endl;
+    return 0;
 }
 
-// Print similarity matrix with precision
-void printSimilarityMatrix(const vector<unordered_set<unsigned long>>& allHashes, const vector<string>& fileNames) {
-    // cout << "\nSimilarity Matrix:" << endl;
-    cout << "\t";
-    for (const auto& name : fileNames) {
-        cout << name << " ";
+// Report each query file's archived matches
+int runQuery(const string& indexPath, const vector<string>& fileNames, double threshold, int topK) {
+    FingerprintIndex index;
+    if (!index.load(indexPath)) {
+        cerr << "Error: cannot load fingerprint index " << indexPath << endl;
+        return 1;
     }
-    cout << endl;
-
-    for (size_t i = 0; i < allHashes.size(); ++i) {
-        cout << fileNames[i] << " ";
-        for (size_t j = 0; j < allHashes.size(); ++j) {
-            double similarity = computeJaccard(allHashes[i], allHashes[j]);
-            cout << fixed << setprecision(2) << similarity << " ";
-            //cout << similarity << " ";
+    if (index.parameters() != pipelineParametersDigest(index.kValue())) {
+        cerr << "Error: " << indexPath << " was built by a different pipeline version; rebuild it" << endl;
+        return 1;
+    }
+
+    vector<unordered_set<unsigned long>> querySets = fingerprintFilesIndependently(fileNames, index.kValue());
+    for (size_t q = 0; q < fileNames.size(); ++q) {
+        vector<IndexMatch> matches = index.query(querySets[q], threshold, topK);
+        cout << "Matches for " << fileNames[q] << " (" << matches.size() << "):" << endl;
+        for (const IndexMatch& m : matches) {
+            cout << "  " << fixed << setprecision(2) << m.similarity << " " << index.documentName(m.documentId) << endl;
         }
-        cout << endl;
     }
+    return 0;
 }
 
 
@@ -248,24 +277,279 @@ void printSimilarityMatrix(const vector<unordered_set<unsigned long>>& allHashes
 // Main Program Logic
 // ---------------------------
 
-int main(int argc, char* argv[]) {
-    // Parse input arguments or hardcode test filenames
-    vector<string> fileNames = {"test-corpus/test1.cpp", "test-corpus/test2.cpp", "test-corpus/test3.cpp", "test-corpus/test4.cpp", "test-corpus/test5.cpp", "test-corpus/test6.cpp"};
+// Command-line options
+struct Options {
+    vector<string> fileNames;
     int k = 3;
-    vector<unordered_set<unsigned long>> allHashes;
-    for (auto& fn : fileNames) {
+    string cacheDir;        // empty = no cache
+    string buildIndexPath;  // --build-index: add the files to this index
+    string queryIndexPath;  // --query: check the files against this index
+    double threshold = 0.25;
+    int topK = 0;           // 0 = every match above the threshold
+    ResultFormat format = ResultFormat::Matrix;
+    string outputPath;      // empty = stdout
+    string checkpointDir;   // empty = no checkpoints
+    bool resume = false;
+    int checkpointInterval = 60; // seconds between ingest checkpoints
+};
+
+void printUsage(const char* program) {
+    cerr << "Usage: " << program << " [-k N] [--cache DIR] [file ...]\n"
+         << "       " << program << " [-k N] [--format F] [--output FILE] [--threshold T] [file ...]\n"
+         << "       " << program << " [-k N] --checkpoint DIR [--resume] [file ...]\n"
+         << "       " << program << " [-k N] --build-index INDEX file ...\n"
+         << "       " << program << " --query INDEX [--threshold T] [--top K] file ...\n"
+         << "  -k N                 k-gram size (default 3)\n"
+         << "  --cache DIR          reuse fingerprints and pair similarities from earlier runs\n"
+         << "  --build-index INDEX  add the files to a persisted fingerprint index\n"
+         << "  --query INDEX        report each file's matches in the index\n"
+         << "  --threshold T        minimum Jaccard similarity to report, 0 to 1 (default 0.25)\n"
+         << "  --top K              report at most K matches per query file\n"
+         << "  --format F           matrix (default), sparse, csv, jsonl or binary\n"
+         << "  --output FILE        write the results to FILE instead of stdout\n"
+         << "  --checkpoint DIR     periodically save progress of the all-pairs run to DIR\n"
+         << "  --resume             continue from the checkpoint in DIR instead of starting over\n"
+         << "  --checkpoint-interval S  whole seconds (>= 1) between fingerprint-state checkpoints (default 60)\n"
+         << "  --trace LEVEL[:CATEGORY,...]  debug output: off, error, warn, info, debug or trace,\n"
+         << "                       optionally limited to input, normalize, tokenize, kgram, hash,\n"
+         << "                       similarity, index or cache\n"
+         << "  --trace-file FILE    write the debug output to FILE instead of stderr\n"
+         << "  --timeline FILE      record a Chrome trace-event timeline of the run in FILE\n"
+         << "With no files, the bundled test corpus is used.\n";
+}
+
+// A whole decimal number no smaller than `minimum`; rejects "", "12s", "-3", ...
+bool parseInteger(const char* text, int minimum, int& value) {
+    const char* end = text + strlen(text);
+    int parsed = 0;
+    auto [ptr, error] = from_chars(text, end, parsed);
+    if (error != errc() || ptr != end || ptr == text || parsed < minimum) return false;
+    value = parsed;
+    return true;
+}
+
+// A decimal number in [0, 1]; rejects "", "0.3x", "7", "nan", ...
+bool parseFraction(const char* text, double& value) {
+    const char* end = text + strlen(text);
+    double parsed = 0;
+    auto [ptr, error] = from_chars(text, end, parsed);
+    if (error != errc() || ptr != end || ptr == text || !(parsed >= 0 && parsed <= 1)) return false;
+    value = parsed;
+    return true;
+}
+
+bool parseArguments(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "-k" && hasValue) {
+            if (!parseInteger(argv[++i], 1, options.k)) return false;
+        } else if (arg == "--cache" && hasValue) {
+            options.cacheDir = argv[++i];
+        } else if (arg == "--build-index" && hasValue) {
+            options.buildIndexPath = argv[++i];
+        } else if (arg == "--query" && hasValue) {
+            options.queryIndexPath = argv[++i];
+        } else if (arg == "--threshold" && hasValue) {
+            if (!parseFraction(argv[++i], options.threshold)) return false;
+        } else if (arg == "--top" && hasValue) {
+            if (!parseInteger(argv[++i], 0, options.topK)) return false;
+        } else if (arg == "--format" && hasValue) {
+            if (!parseResultFormat(argv[++i], options.format)) return false;
+        } else if (arg == "--output" && hasValue) {
+            options.outputPath = argv[++i];
+        } else if (arg == "--checkpoint" && hasValue) {
+            options.checkpointDir = argv[++i];
+        } else if (arg == "--checkpoint-interval" && hasValue) {
+            if (!parseInteger(argv[++i], 1, options.checkpointInterval)) return false;
+        } else if (arg == "--trace" && hasValue) {
+            if (!configureTrace(argv[++i])) return false;
+        } else if (arg == "--trace-file" && hasValue) {
+            if (!setTraceFile(argv[++i])) {
+                cerr << "Error: cannot write trace file " << argv[i] << "\n";
+                return false;
+            }
+        } else if (arg == "--timeline" && hasValue) {
+            if (!startTimeline(argv[++i])) {
+                cerr << "Error: cannot write timeline " << argv[i] << "\n";
+                return false;
+            }
+            nameTimelineThread("main");
+        } else if (arg == "--resume") {
+            options.resume = true;
+        } else if (arg == "-h" || arg == "--help" || arg[0] == '-') {
+            return false;
+        } else {
+            options.fileNames.push_back(arg);
+        }
+    }
+    if (!options.buildIndexPath.empty() && !options.queryIndexPath.empty()) {
+        return false;
+    }
+    if (options.resume && options.checkpointDir.empty()) {
+        return false;
+    }
+    if (options.fileNames.empty()) {
+        options.fileNames = {"test-corpus/test1.cpp", "test-corpus/test2.cpp", "test-corpus/test3.cpp", "test-corpus/test4.cpp", "test-corpus/test5.cpp", "test-corpus/test6.cpp"};
+    }
+    return options.k > 0 && options.topK >= 0;
+}
+
+// Default mode: all-pairs similarity matrix over the given files
+int runAllPairs(const Options& options) {
+    const vector<string>& fileNames = options.fileNames;
+    int k = options.k;
+    unique_ptr<FingerprintCache> cache;
+    uint64_t parametersDigest = pipelineParametersDigest(k);
+    if (!options.cacheDir.empty()) {
+        cache = make_unique<FingerprintCache>(options.cacheDir);
+    }
+
+    // Files whose raw bytes, or whose normalized token stream, match an earlier file
+    // share that file's fingerprint set: they are fingerprinted and compared only once
+    IngestState state;
+
+    unique_ptr<RunCheckpoint> checkpoint;
+    if (!options.checkpointDir.empty()) {
+        checkpoint = make_unique<RunCheckpoint>(options.checkpointDir, runIdentityDigest(fileNames, parametersDigest));
+        if (!options.resume) {
+            checkpoint->clear();
+        } else if (checkpoint->loadIngest(state, variableMap, varCounter)) {
+            cerr << "Resuming after " << state.nextFile << " of " << fileNames.size() << " file(s)\n";
+        } else {
+            cerr << "No usable checkpoint in " << options.checkpointDir << "; starting from the beginning\n";
+        }
+    }
+    auto lastCheckpoint = chrono::steady_clock::now();
+
+    for (; state.nextFile < fileNames.size(); ++state.nextFile) {
+        if (checkpoint && chrono::steady_clock::now() - lastCheckpoint >= chrono::seconds(options.checkpointInterval)) {
+            checkpoint->saveIngest(state, variableMap, varCounter);
+            lastCheckpoint = chrono::steady_clock::now();
+        }
+
+        const string& fn = fileNames[state.nextFile];
+        TIMELINE_SCOPE_ARG(TraceCategory::Input, "file", "path", fn);
         ifstream in(fn);
         if (!in) { cerr << "Cannot open " << fn << "\n"; continue; }
         string code((istreambuf_iterator<char>(in)), {});
-        string clean = normalizeSpacesAndLines(code);
-        clean = removeComments(clean);
-        clean = normalizeVariables(clean);
-        auto tok = tokenize(clean);
-        cout << "Tokens for " << fn << ":\n";
-        for (auto& t : tok) cout << t << " "; cout << "\n";
-        allHashes.push_back(hashKGrams(createKGrams(tok, k)));
+        state.loadedNames.push_back(fn);
+
+        uint64_t bytesDigest = digestString(code);
+        auto duplicate = state.distinctByBytes.find(bytesDigest);
+        if (duplicate != state.distinctByBytes.end()) {
+            // An exact copy declares only variables its original already registered,
+            // so skipping it leaves the variable numbering of later files unchanged
+            state.distinctOf.push_back(duplicate->second);
+            TRACE(TraceLevel::Debug, TraceCategory::Input, fn << ": identical to " << state.distinctNames[duplicate->second]);
+            continue;
+        }
+
+        uint64_t key = 0;
+        if (cache) {
+            key = combineDigest(combineDigest(parametersDigest, bytesDigest), state.variableMapDigest);
+            CacheEntry entry;
+            if (cache->lookup(key, entry)) {
+                // Replay the variables this file introduced so later files number theirs identically
+                for (const auto& [original, normalized] : entry.newVariables) {
+                    variableMap[original] = normalized;
+                    state.variableMapDigest = combineDigest(state.variableMapDigest, digestString(original));
+                }
+                varCounter = entry.varCounterAfter;
+                // Group token-level duplicates exactly as a cold run would
+                auto sameTokens = state.distinctByTokens.find(entry.tokensDigest);
+                int distinct;
+                if (sameTokens != state.distinctByTokens.end()) {
+                    distinct = sameTokens->second;
+                } else {
+                    distinct = state.allHashes.size();
+                    state.distinctByTokens[entry.tokensDigest] = distinct;
+                    state.distinctNames.push_back(fn);
+                    state.allHashes.emplace_back(entry.fingerprints.begin(), entry.fingerprints.end());
+                }
+                state.distinctByBytes[bytesDigest] = distinct;
+                state.distinctOf.push_back(distinct);
+                TRACE(TraceLevel::Debug, TraceCategory::Cache, fn << ": " << entry.fingerprints.size() << " fingerprints from the cache");
+                continue;
+            }
+        }
+
+        int counterBefore = varCounter;
+        auto tok = normalizeAndTokenize(code);
+        TRACE(TraceLevel::Debug, TraceCategory::Tokenize, "Tokens for " << fn << ": " << joinTokens(tok));
+
+        uint64_t tokensDigest = tok.size();
+        for (const string& t : tok) {
+            tokensDigest = combineDigest(tokensDigest, digestString(t));
+        }
+        auto sameTokens = state.distinctByTokens.find(tokensDigest);
+        int distinct;
+        if (sameTokens != state.distinctByTokens.end()) {
+            distinct = sameTokens->second;
+        } else {
+            distinct = state.allHashes.size();
+            state.distinctByTokens[tokensDigest] = distinct;
+            state.distinctNames.push_back(fn);
+            state.allHashes.push_back(hashKGrams(createKGrams(tok, k)));
+        }
+        state.distinctByBytes[bytesDigest] = distinct;
+        state.distinctOf.push_back(distinct);
+
+        if (cache) {
+            CacheEntry entry;
+            entry.fingerprints.assign(state.allHashes[distinct].begin(), state.allHashes[distinct].end());
+            sort(entry.fingerprints.begin(), entry.fingerprints.end());
+            entry.newVariables = variablesAddedSince(counterBefore);
+            entry.varCounterAfter = varCounter;
+            entry.tokensDigest = tokensDigest;
+            for (const auto& [original, normalized] : entry.newVariables) {
+                state.variableMapDigest = combineDigest(state.variableMapDigest, digestString(original));
+            }
+            cache->store(key, entry);
+        }
     }
-    printSimilarityMatrix(allHashes, fileNames);
-    return 0;
+    if (checkpoint) {
+        checkpoint->saveIngest(state, variableMap, varCounter);
+    }
+
+    // Each row is written as soon as it is computed
+    bool written = false;
+    {
+        TIMELINE_SCOPE(TraceCategory::Similarity, "compare");
+        SimilarityResultStream results(options.format, state.loadedNames, options.threshold, options.outputPath);
+        if (results.isOpen()) {
+            SimilarityRows rows(state.allHashes, state.distinctOf, results.needsFullRows(), cache.get(), checkpoint.get());
+            for (size_t i = 0; i < state.loadedNames.size(); ++i) {
+                results.writeRow(i, rows.fileRow(i));
+            }
+            written = results.finish();
+        }
+    }
+
+    if (state.loadedNames.size() > state.allHashes.size()) {
+        cerr << "Duplicates: " << state.loadedNames.size() - state.allHashes.size() << " file(s) duplicated an earlier file (identical bytes or token stream)\n";
+    }
+    if (cache) {
+        cache->save();
+        cerr << "Cache: " << cache->hits() << " file(s) reused, " << cache->misses() << " recomputed\n";
+    }
+    if (checkpoint && written) {
+        checkpoint->clear(); // the results are out; nothing left to resume
+    }
+    return written ? 0 : 1;
 }
 
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseArguments(argc, argv, options)) {
+        printUsage(argv[0]);
+        return 1;
+    }
+    if (!options.buildIndexPath.empty()) {
+        return runBuildIndex(options.buildIndexPath, options.fileNames, options.k);
+    }
+    if (!options.queryIndexPath.empty()) {
+        return runQuery(options.queryIndexPath, options.fileNames, options.threshold, options.topK);
+    }
+    return runAllPairs(options);
+}
@@ -0,0 +1,223 @@
+/**
+ * Similarity Result Writer — implementation
+ * (see result_writer.h for the formats)
+ */
+
+#include "result_writer.h"
+
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+using namespace std;
+
+const uint32_t MATRIX_MAGIC = 0x4D533650; // "P6SM" on little-endian machines
+const uint32_t MATRIX_FORMAT_VERSION = 1;
+
+bool parseResultFormat(const string& name, ResultFormat& format) {
+    if (name == "matrix") format = ResultFormat::Matrix;
+    else if (name == "sparse") format = ResultFormat::Sparse;
+    else if (name == "csv") format = ResultFormat::Csv;
+    else if (name == "jsonl") format = ResultFormat::JsonLines;
+    else if (name == "binary") format = ResultFormat::Binary;
+    else return false;
+    return true;
+}
+
+// ---------------------------
+// Buffered writer
+// ---------------------------
+
+ResultWriter::ResultWriter(FILE* out, size_t bufferSize) : out(out), buffer(bufferSize) {}
+
+ResultWriter::~ResultWriter() {
+    flush();
+}
+
+bool ResultWriter::flush() {
+    if (used > 0 && !failed) {
+        failed = fwrite(buffer.data(), 1, used, out) != used;
+    }
+    used = 0;
+    return !failed && fflush(out) == 0;
+}
+
+void ResultWriter::reserve(size_t length) {
+    if (used + length > buffer.size()) {
+        if (used > 0 && !failed) {
+            failed = fwrite(buffer.data(), 1, used, out) != used;
+        }
+        used = 0;
+        if (length > buffer.size()) buffer.resize(length);
+    }
+}
+
+void ResultWriter::write(string_view text) {
+    reserve(text.size());
+    memcpy(buffer.data() + used, text.data(), text.size());
+    used += text.size();
+}
+
+void ResultWriter::write(char c) {
+    reserve(1);
+    buffer[used++] = c;
+}
+
+void ResultWriter::writeBytes(const void* data, size_t length) {
+    write(string_view(static_cast<const char*>(data), length));
+}
+
+void ResultWriter::writeNumber(double value, int precision) {
+    const size_t maxLength = 32;
+    reserve(maxLength);
+    char* first = buffer.data() + used;
+    to_chars_result result = precision < 0
+        ? to_chars(first, first + maxLength, value)
+        : to_chars(first, first + maxLength, value, chars_format::fixed, precision);
+    used = result.ptr - buffer.data();
+}
+
+// ---------------------------
+// Output formats
+// ---------------------------
+
+// Names are escaped once up front rather than once per pair they appear in
+static string csvField(const string& s) {
+    if (s.find_first_of(",\"\n") == string::npos) return s;
+    string quoted = "\"";
+    for (char c : s) {
+        if (c == '"') quoted += '"';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+static string jsonString(const string& s) {
+    static const char hexDigits[] = "0123456789abcdef";
+    string quoted = "\"";
+    for (unsigned char c : s) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+            quoted += c;
+        } else if (c < 0x20) {
+            quoted += "\\u00";
+            quoted += hexDigits[c >> 4];
+            quoted += hexDigits[c & 0xF];
+        } else {
+            quoted += c;
+        }
+    }
+    return quoted + "\"";
+}
+
+SimilarityResultStream::SimilarityResultStream(ResultFormat format, const vector<string>& fileNames, double threshold,
+                                               const string& outputPath)
+    : format(format), fileNames(fileNames), threshold(threshold) {
+    out = stdout;
+    if (!outputPath.empty()) {
+        out = fopen(outputPath.c_str(), format == ResultFormat::Binary ? "wb" : "w");
+        if (!out) {
+            cerr << "Error: cannot open " << outputPath << " for writing" << endl;
+            return;
+        }
+    }
+    writer = make_unique<ResultWriter>(out);
+    ResultWriter& w = *writer;
+
+    switch (format) {
+        case ResultFormat::Matrix:
+            w.write('\t');
+            for (const auto& name : fileNames) {
+                w.write(name);
+                w.write(' ');
+            }
+            w.write('\n');
+            break;
+        case ResultFormat::Sparse:
+            break;
+        case ResultFormat::Csv:
+            for (const auto& name : fileNames) fields.push_back(csvField(name) + ",");
+            w.write("file_a,file_b,similarity\n");
+            break;
+        case ResultFormat::JsonLines:
+            for (const auto& name : fileNames) fields.push_back(jsonString(name));
+            break;
+        case ResultFormat::Binary: {
+            uint32_t header[3] = {MATRIX_MAGIC, MATRIX_FORMAT_VERSION, static_cast<uint32_t>(fileNames.size())};
+            w.writeBytes(header, sizeof(header));
+            for (const auto& name : fileNames) {
+                uint32_t length = static_cast<uint32_t>(name.size());
+                w.writeBytes(&length, sizeof(length));
+                w.write(name);
+            }
+            break;
+        }
+    }
+}
+
+SimilarityResultStream::~SimilarityResultStream() {
+    if (writer) finish();
+}
+
+void SimilarityResultStream::writeRow(size_t i, const vector<double>& row) {
+    ResultWriter& w = *writer;
+    size_t n = fileNames.size();
+    switch (format) {
+        case ResultFormat::Matrix:
+            w.write(fileNames[i]);
+            w.write(' ');
+            for (size_t j = 0; j < n; ++j) {
+                w.writeNumber(i == j ? 1.0 : row[j], 2);
+                w.write(' ');
+            }
+            w.write('\n');
+            break;
+        case ResultFormat::Sparse:
+            for (size_t j = i + 1; j < n; ++j) {
+                if (row[j] < threshold) continue;
+                w.write(fileNames[i]);
+                w.write(' ');
+                w.write(fileNames[j]);
+                w.write(' ');
+                w.writeNumber(row[j], 2);
+                w.write('\n');
+            }
+            break;
+        case ResultFormat::Csv:
+            for (size_t j = i + 1; j < n; ++j) {
+                w.write(fields[i]);
+                w.write(fields[j]);
+                w.writeNumber(row[j]);
+                w.write('\n');
+            }
+            break;
+        case ResultFormat::JsonLines:
+            for (size_t j = i + 1; j < n; ++j) {
+                w.write("{\"a\":");
+                w.write(fields[i]);
+                w.write(",\"b\":");
+                w.write(fields[j]);
+                w.write(",\"similarity\":");
+                w.writeNumber(row[j]);
+                w.write("}\n");
+            }
+            break;
+        case ResultFormat::Binary:
+            floats.assign(row.begin() + i + 1, row.end());
+            w.writeBytes(floats.data(), floats.size() * sizeof(float));
+            break;
+    }
+}
+
+bool SimilarityResultStream::finish() {
+    if (!writer) return false;
+    bool ok = writer->flush();
+    writer.reset();
+    if (out != stdout) {
+        ok = fclose(out) == 0 && ok;
+    }
+    if (!ok) {
+        cerr << "Error: writing results failed" << endl;
+    }
+    return ok;
+}
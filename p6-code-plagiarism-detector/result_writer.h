@@ -0,0 +1,88 @@
+/**
+ * Similarity Result Writer
+ * ========================
+ *
+ * Writes the pairwise similarity results in one of several formats through a
+ * single large buffer, formatting numbers with std::to_chars instead of
+ * iostream manipulators, so writing an n x n result is bound by I/O rather
+ * than by per-cell formatting.
+ *
+ * Formats:
+ *   matrix   full n x n matrix, 2 decimals (the classic project6 output)
+ *   sparse   "fileA fileB similarity" for pairs at or above the threshold
+ *   csv      file_a,file_b,similarity for every pair (i < j)
+ *   jsonl    one {"a":..,"b":..,"similarity":..} object per pair (i < j)
+ *   binary   "P6SM" header, file names, then the upper triangle (i < j,
+ *            row-major) as n(n-1)/2 native-endian float32 values
+ *
+ * Results are streamed one row at a time through SimilarityResultStream, so
+ * the writer never needs the whole n x n matrix: every format but matrix only
+ * reads the cells right of the diagonal, and each row is written as soon as
+ * it is handed over.
+ */
+
+#ifndef RESULT_WRITER_H
+#define RESULT_WRITER_H
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class ResultFormat { Matrix, Sparse, Csv, JsonLines, Binary };
+
+bool parseResultFormat(const std::string& name, ResultFormat& format);
+
+// Buffered output to a FILE* (not owned); flushes when full and on destruction
+class ResultWriter {
+public:
+    explicit ResultWriter(FILE* out, size_t bufferSize = 1 << 20);
+    ~ResultWriter();
+
+    void write(std::string_view text);
+    void write(char c);
+    void writeBytes(const void* data, size_t length);
+    // precision < 0 writes the shortest representation that round-trips
+    void writeNumber(double value, int precision = -1);
+    bool flush();
+
+private:
+    void reserve(size_t length);
+
+    FILE* out;
+    std::vector<char> buffer;
+    size_t used = 0;
+    bool failed = false;
+};
+
+// Writes the pairwise results row by row: open, writeRow(0) ... writeRow(n-1), finish
+class SimilarityResultStream {
+public:
+    // outputPath empty = stdout; check isOpen() before writing rows
+    SimilarityResultStream(ResultFormat format, const std::vector<std::string>& fileNames, double threshold,
+                           const std::string& outputPath = "");
+    ~SimilarityResultStream();
+
+    bool isOpen() const { return writer != nullptr; }
+
+    // True if writeRow reads the cells left of the diagonal (matrix format)
+    bool needsFullRows() const { return format == ResultFormat::Matrix; }
+
+    // Row i of the n x n matrix: row[j] for j > i, and for every j if needsFullRows()
+    void writeRow(size_t i, const std::vector<double>& row);
+
+    // Flush and close; false (with a message) if any write failed
+    bool finish();
+
+private:
+    ResultFormat format;
+    const std::vector<std::string>& fileNames;
+    double threshold;
+    std::vector<std::string> fields; // names escaped once for csv / jsonl
+    std::vector<float> floats;       // scratch row for binary
+    FILE* out = nullptr;
+    std::unique_ptr<ResultWriter> writer;
+};
+
+#endif // RESULT_WRITER_H